@@ -0,0 +1,389 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "sokoban/BitBoard.hpp"
+#include "sokoban/Board.hpp"
+#include "sokoban/FixedBoard.hpp"
+
+#ifdef SOKOBAN_BENCH_DRAW
+#include <SFML/Graphics.hpp>
+#include "sokoban/Sokoban.hpp"
+#endif
+
+namespace {
+struct Result {
+    std::string name;
+    size_t ops{0};
+    double seconds{0};
+    size_t bytes{0};  // bytes handled per op, 0 if it does not apply
+
+    double nsPerOp() const { return ops ? 1e9 * seconds / ops : 0; }
+};
+
+// Runs the benchmark with growing repeat counts until one run takes at
+// least minTime seconds. body(n) performs n operations and returns how many
+// it really did.
+class Runner {
+ public:
+    Runner(double minTime, std::string filter) : _minTime(minTime), _filter(std::move(filter)) {}
+
+    void run(const std::string& name, const std::function<size_t(size_t)>& body,
+             size_t bytes = 0) {
+        if (name.find(_filter) == std::string::npos) {
+            return;
+        }
+        Result result{name, 0, 0, bytes};
+        size_t n = 1;
+        while (true) {
+            auto start = std::chrono::steady_clock::now();
+            size_t ops = body(n);
+            double seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+            if (seconds >= _minTime || n >= (size_t(1) << 40)) {
+                result.ops = ops;
+                result.seconds = seconds;
+                break;
+            }
+            // aim a bit past the target so the next run usually is the last
+            double scale = seconds > 0 ? 1.5 * _minTime / seconds : 100;
+            n = static_cast<size_t>(n * std::min(100.0, std::max(2.0, scale)));
+        }
+        std::cerr << std::left << std::setw(32) << name << std::right << std::fixed <<
+                     std::setprecision(1) << std::setw(12) << result.nsPerOp() << " ns/op" << std::endl;
+        _results.push_back(result);
+    }
+
+    const std::vector<Result>& results() const { return _results; }
+
+ private:
+    double _minTime;
+    std::string _filter;
+    std::vector<Result> _results;
+};
+
+SB::Board parse(const std::string& text) {
+    std::istringstream in(text);
+    SB::Board board;
+    in >> board;
+    return board;
+}
+
+// An open room with the player next to a crate and one goal in a corner. The
+// loop pushes the crate right, walks around it, pushes it back and returns,
+// so the board is the same after every lap.
+const std::string PUSH_LAP = "RurrdLdllu";
+
+std::string room(unsigned int width, unsigned int height) {
+    std::ostringstream out;
+    out << height << " " << width << "\n";
+    for (unsigned int y = 0; y < height; y++) {
+        for (unsigned int x = 0; x < width; x++) {
+            bool wall = x == 0 || y == 0 || x == width - 1 || y == height - 1;
+            char c = wall ? '#' : '.';
+            if (x == 1 && y == 1) {
+                c = 'a';
+            } else if (y == height / 2 && x == width / 2) {
+                c = '@';
+            } else if (y == height / 2 && x == width / 2 + 1) {
+                c = 'A';
+            }
+            out << c;
+        }
+        out << "\n";
+    }
+    return out.str();
+}
+
+template <typename B>
+size_t laps(B* board, const std::string& lap, size_t n) {
+    std::vector<SB::Direction> dirs;
+    for (char c : lap) {
+        SB::Direction dir;
+        SB::fromLurd(c, &dir);
+        dirs.push_back(dir);
+    }
+    size_t moves = 0;
+    for (size_t i = 0; i < n; i++) {
+        for (SB::Direction dir : dirs) {
+            moves += board->movePlayer(dir);
+        }
+    }
+    return moves;
+}
+
+void benchMoves(Runner& runner, const std::string& size, const std::string& level) {
+    SB::Board board = parse(level);
+    runner.run("movePlayer/walk/" + size, [&board](size_t n) {
+        return laps(&board, "rl", n);
+    });
+    runner.run("movePlayer/push/" + size, [&board](size_t n) {
+        return laps(&board, PUSH_LAP, n);
+    });
+}
+
+void benchHistory(Runner& runner, const std::string& level) {
+    for (size_t history : {1000, 100000, 1000000}) {
+        SB::Board board = parse(level);
+        board.setHistoryLimit(history);
+        laps(&board, PUSH_LAP, history / PUSH_LAP.size() + 1);
+        size_t length = board.history().undoCount();
+        // unwinds the whole history and replays it, so the cost per step shows
+        // whether it depends on how long the history is
+        runner.run("undo+redo/history=" + std::to_string(history), [&board, length](size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                for (size_t j = 0; j < length; j++) {
+                    board.undo();
+                }
+                for (size_t j = 0; j < length; j++) {
+                    board.redo();
+                }
+            }
+            return 2 * length * n;
+        });
+    }
+
+    // a million moves in a 1 MB archive; every jump restores a checkpoint and
+    // replays less than one interval, however far back it goes
+    SB::Board board = parse(level);
+    board.setHistoryLimit(1000);
+    board.setHistoryBudget(1 << 20);
+    laps(&board, PUSH_LAP, 1000000 / PUSH_LAP.size() + 1);
+    runner.run("jumpTo/history=1000000", [&board](size_t n) {
+        size_t first = board.firstMove(), span = board.lastMove() - first;
+        uint32_t seed = 1;
+        for (size_t i = 0; i < n; i++) {
+            seed = seed * 1103515245 + 12345;
+            board.jumpTo(first + seed % span);
+        }
+        return n;
+    });
+}
+
+void benchText(Runner& runner, const std::string& size, const std::string& level) {
+    runner.run("operator>>/" + size, [&level](size_t n) {
+        size_t cells = 0;
+        for (size_t i = 0; i < n; i++) {
+            cells += parse(level).size();
+        }
+        return cells ? n : 0;
+    }, level.size());
+
+    SB::Board board = parse(level);
+    runner.run("operator<</" + size, [&board](size_t n) {
+        std::ostringstream out;
+        for (size_t i = 0; i < n; i++) {
+            out.str("");
+            out << board;
+        }
+        return n;
+    }, level.size());
+
+    runner.run("isWon/" + size, [&board](size_t n) {
+        size_t won = 0;
+        for (size_t i = 0; i < n; i++) {
+            won += board.isWon();
+        }
+        return won <= n ? n : 0;
+    });
+}
+
+void benchBits(Runner& runner, const std::string& size, const std::string& level) {
+    SB::BitBoard board(parse(level));
+    runner.run("BitBoard/movePlayer/push/" + size, [&board](size_t n) {
+        return laps(&board, PUSH_LAP, n);
+    });
+    runner.run("BitBoard/isWon/" + size, [&board](size_t n) {
+        size_t won = 0;
+        for (size_t i = 0; i < n; i++) {
+            won += board.isWon();
+        }
+        return won <= n ? n : 0;
+    }, (board.size() + 7) / 8);
+    runner.run("BitBoard/isDeadlocked/" + size, [&board](size_t n) {
+        size_t deadlocked = 0;
+        for (size_t i = 0; i < n; i++) {
+            deadlocked += board.isDeadlocked();
+        }
+        return deadlocked <= n ? n : 0;
+    }, (board.size() + 7) / 8);
+}
+
+void benchFixed(Runner& runner, const std::string& size, const std::string& level) {
+    SB::FixedBoard<16, 16> board(parse(level));
+    runner.run("FixedBoard/movePlayer/push/" + size, [&board](size_t n) {
+        return laps(&board, PUSH_LAP, n);
+    });
+    runner.run("FixedBoard/isWon/" + size, [&board](size_t n) {
+        size_t won = 0;
+        for (size_t i = 0; i < n; i++) {
+            won += board.isWon();
+        }
+        return won <= n ? n : 0;
+    });
+}
+
+#ifdef SOKOBAN_BENCH_DRAW
+void benchDraw(Runner& runner, const std::string& size, const std::string& level) {
+    SB::Sokoban game;
+    std::istringstream in(level);
+    in >> game;
+    while (!game.assetsLoaded()) {
+        game.updateAssets();
+        sf::sleep(sf::milliseconds(1));
+    }
+    if (game.assetsFailed()) {
+        std::cerr << "skipping draw/" << size << ": tile images do not fit the atlas" << std::endl;
+        return;
+    }
+    sf::RenderTexture target;
+    if (!target.create(game.pixelWidth(), game.pixelHeight())) {
+        std::cerr << "skipping draw/" << size << ": render texture too large" << std::endl;
+        return;
+    }
+    runner.run("draw/" + size, [&](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            target.clear();
+            target.draw(game);
+            target.display();
+        }
+        return n;
+    });
+    runner.run("draw+move/" + size, [&](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            game.movePlayer(i % 2 ? SB::Direction::Left : SB::Direction::Right);
+            target.clear();
+            target.draw(game);
+            target.display();
+        }
+        return n;
+    });
+}
+#endif
+
+void writeJson(std::ostream& out, const std::vector<Result>& results) {
+#ifdef NDEBUG
+    const char* build = "release";
+#else
+    const char* build = "debug";
+#endif
+    out << "{\"build\": \"" << build << "\", \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& result = results[i];
+        // one result per line, so baselines can be read back without a JSON parser
+        out << "  {\"name\": \"" << result.name << "\", \"ops\": " << result.ops <<
+               ", \"seconds\": " << std::setprecision(6) << std::fixed << result.seconds <<
+               ", \"ns_per_op\": " << std::setprecision(3) << result.nsPerOp();
+        if (result.bytes > 0) {
+            out << ", \"mb_per_second\": " <<
+                   result.bytes * result.ops / result.seconds / 1e6;
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]}\n";
+}
+
+// reads name -> ns_per_op from a file written by writeJson
+std::map<std::string, double> readBaseline(const std::string& filename) {
+    std::ifstream ifs(filename);
+    if (!ifs.is_open()) {
+        throw std::runtime_error("Failed to open " + filename);
+    }
+    std::map<std::string, double> baseline;
+    std::string line;
+    const std::string nameKey = "\"name\": \"", timeKey = "\"ns_per_op\": ";
+    while (std::getline(ifs, line)) {
+        size_t name = line.find(nameKey);
+        size_t time = line.find(timeKey);
+        if (name == std::string::npos || time == std::string::npos) {
+            continue;
+        }
+        name += nameKey.size();
+        baseline[line.substr(name, line.find('"', name) - name)] =
+            std::stod(line.substr(time + timeKey.size()));
+    }
+    return baseline;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    double minTime = 0.5;
+    std::string filter, output, baselineFile;
+    double tolerance = 0.10;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--time" && hasValue) {
+            minTime = std::stod(argv[++i]);
+        } else if (arg == "--filter" && hasValue) {
+            filter = argv[++i];
+        } else if (arg == "--output" && hasValue) {
+            output = argv[++i];
+        } else if (arg == "--baseline" && hasValue) {
+            baselineFile = argv[++i];
+        } else if (arg == "--tolerance" && hasValue) {
+            tolerance = std::stod(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--time seconds] [--filter text]" <<
+            " [--output results.json] [--baseline results.json] [--tolerance 0.10]" << std::endl;
+            return 1;
+        }
+    }
+#ifndef NDEBUG
+    std::cerr << "warning: this is not a release build, the numbers are not comparable" << std::endl;
+#endif
+
+    Runner runner(minTime, filter);
+    const std::string small = room(10, 10);
+    const std::string huge = room(1000, 1000);
+    benchMoves(runner, "10x10", small);
+    benchMoves(runner, "1000x1000", huge);
+    benchHistory(runner, small);
+    benchText(runner, "10x10", small);
+    benchText(runner, "1000x1000", huge);
+    benchBits(runner, "10x10", small);
+    benchBits(runner, "1000x1000", huge);
+    benchFixed(runner, "10x10", small);
+#ifdef SOKOBAN_BENCH_DRAW
+    benchDraw(runner, "10x10", small);
+    benchDraw(runner, "100x100", room(100, 100));
+#endif
+
+    if (output.empty()) {
+        writeJson(std::cout, runner.results());
+    } else {
+        std::ofstream ofs(output);
+        if (!ofs.is_open()) {
+            std::cerr << "Failed to open " << output << std::endl;
+            return 1;
+        }
+        writeJson(ofs, runner.results());
+    }
+
+    if (baselineFile.empty()) {
+        return 0;
+    }
+    // a benchmark that got slower than the baseline by more than the tolerance fails the run
+    int regressions = 0;
+    std::map<std::string, double> baseline = readBaseline(baselineFile);
+    for (const Result& result : runner.results()) {
+        auto it = baseline.find(result.name);
+        if (it != baseline.end() && result.nsPerOp() > it->second * (1 + tolerance)) {
+            std::cerr << "regression: " << result.name << " " << it->second << " -> " <<
+                         result.nsPerOp() << " ns/op" << std::endl;
+            regressions++;
+        }
+    }
+    return regressions ? 2 : 0;
+}
@@ -0,0 +1,79 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+
+#include "sokoban/ThreadPool.hpp"
+#include "sokoban/Trace.hpp"
+
+namespace SB {
+// returns true once the future holds its value, without blocking
+template <typename T>
+bool isReady(const std::shared_future<T>& future) {
+    return future.valid() &&
+           future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+// Loads every asset file at most once per process. Files are decoded on
+// background threads and shared by reference count, so games and windows
+// created later get them for free. The value is null if the file could not
+// be loaded, callers keep drawing their fallbacks in that case.
+class AssetCache {
+ public:
+    template <typename T>
+    using Handle = std::shared_future<std::shared_ptr<const T>>;
+
+    static AssetCache& instance();
+
+    // T is anything with loadFromFile(const std::string&), like sf::Image,
+    // sf::Font or sf::SoundBuffer. The file is also looked for by its base
+    // name in the working directory.
+    template <typename T>
+    Handle<T> load(const std::string& filename) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto key = std::make_pair(std::type_index(typeid(T)), filename);
+        auto it = _entries.find(key);
+        if (it != _entries.end()) {
+            return *std::static_pointer_cast<Handle<T>>(it->second);
+        }
+        auto promise = std::make_shared<std::promise<std::shared_ptr<const T>>>();
+        auto handle = std::make_shared<Handle<T>>(promise->get_future().share());
+        _entries.emplace(key, handle);
+        _loader.submit([promise, filename] {
+            Trace::Scope scope("decode asset", "assets");
+            auto asset = std::make_shared<T>();
+            if (!asset->loadFromFile(filename) && !asset->loadFromFile("./" + baseName(filename))) {
+                asset.reset();
+            }
+            promise->set_value(std::move(asset));
+        });
+        return *handle;
+    }
+
+ private:
+    struct KeyHash {
+      size_t operator()(const std::pair<std::type_index, std::string>& key) const {
+          return key.first.hash_code() ^ std::hash<std::string>()(key.second);
+      }
+    };
+
+    std::mutex _mutex;
+    // each value is a Handle<T> of the type in its key
+    std::unordered_map<std::pair<std::type_index, std::string>,
+                       std::shared_ptr<void>, KeyHash> _entries;
+    ThreadPool _loader{2};
+
+    AssetCache() = default;
+    static std::string baseName(const std::string& filename) {
+        return filename.substr(filename.find_last_of('/') + 1);
+    }
+};
+}  // namespace SB
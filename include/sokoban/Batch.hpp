@@ -0,0 +1,45 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "sokoban/Board.hpp"
+#include "sokoban/Solver.hpp"
+#include "sokoban/ThreadPool.hpp"
+
+namespace SB {
+struct BatchLevel {
+    std::string name;
+    Board board;
+    std::string error;  // set instead of a board when the file could not be read
+};
+
+struct BatchResult {
+    std::string name;
+    Solution solution;
+    double seconds{0};
+    std::string error;  // set instead of a solution when the search threw
+};
+
+// returns true for the .xsb and .sok files of standard level collections
+bool isXsbFile(const std::string& filename);
+
+// Reads every level of a file holding one or more levels back to back,
+// .xsb and .sok files are read as XSB collections
+std::vector<BatchLevel> loadLevelFile(const std::string& filename);
+// Reads every .lvl, .xsb and .sok file of a directory, or every level of a
+// single file, sorted by file name. A file of a directory that cannot be
+// read comes back as one level with its error set, the others still load
+std::vector<BatchLevel> loadLevels(const std::string& path);
+
+// Solves every level on the pool, results come back in the order of the levels
+std::vector<BatchResult> solveBatch(const std::vector<BatchLevel>& levels,
+                                    const SolverOptions& options, ThreadPool& pool);
+
+void writeCsv(std::ostream& out, const std::vector<BatchResult>& results);
+void writeJson(std::ostream& out, const std::vector<BatchResult>& results);
+}  // namespace SB
@@ -0,0 +1,104 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "sokoban/Board.hpp"
+#include "sokoban/MoveJournal.hpp"
+#include "sokoban/TileType.hpp"
+
+namespace SB {
+// The game rules on packed bitsets, one bit per cell for walls, goals and
+// crates, for jobs that check many positions and never draw them. isWon(),
+// isDeadlocked() and the reachability flood fill work on whole words, 128
+// bits at a time where SSE2 is available. The walls, goals and dead squares
+// are shared between copies, so a copy only duplicates the crates and the
+// history. Moves, undo and redo behave like Board's.
+class BitBoard {
+ public:
+    BitBoard() = default;
+    // takes the level and the current position from the board
+    explicit BitBoard(const Board& board);
+
+    unsigned int height() const { return _level ? _level->height : 0; }
+    unsigned int width() const { return _level ? _level->width : 0; }
+    size_t size() const { return static_cast<size_t>(width()) * height(); }
+
+    bool isWall(size_t i) const { return _test(_level->walls, i); }
+    bool isGoal(size_t i) const { return _test(_level->goals, i); }
+    bool isCrate(size_t i) const { return _test(_crates, i); }
+    // the tile Board would show on this cell, without the locked crate tiles
+    TileType operator[](size_t i) const;
+
+    // returns the player's current position, with (0, 0) as the top-left corner
+    Position playerLoc() const;
+    size_t playerIndex() const { return _playerPosition.y * width() + _playerPosition.x; }
+
+    // returns true if every goal holds a crate, or every crate sits on a goal
+    // when there are fewer crates than goals
+    bool isWon() const;
+    // returns true if a crate off its goal sits on a dead square, or in a
+    // 2x2 block of walls and crates. Board's frozen crate check finds more,
+    // this is the part that can be tested on whole words.
+    bool isDeadlocked() const;
+    // returns true if the player can walk to the cell without pushing a
+    // crate. The flood fill behind it is only redone after a push.
+    bool canReach(Position pos) const;
+
+    bool movePlayer(Direction dir);
+    unsigned int getMoveCount() const { return _moveCount; }
+    unsigned int getPushCount() const { return _pushCount; }
+
+    void reset();
+    void undo();
+    void redo();
+
+    // the moves that can be undone and redone, see Board::history()
+    const MoveJournal& history() const { return _journal; }
+    void setHistoryLimit(size_t limit) { _journal.setLimit(limit); }
+
+ private:
+    using Bits = std::vector<uint64_t>;
+
+    // what never changes while the level is played
+    struct Level {
+      unsigned int width{0};
+      unsigned int height{0};
+      unsigned int crateCount{0};
+      unsigned int goalCount{0};
+      Bits walls;
+      Bits goals;
+      Bits dead;         // dead squares that are not goals
+      Bits floor;        // cells that are not walls
+      Bits notFirst;     // cells off the first column
+      Bits notLast;      // cells off the last column
+      Bits squares;      // top-left cells of every 2x2 block on the board
+      Bits crates;       // the position the board started from
+      Position player{0, 0};
+    };
+
+    std::shared_ptr<const Level> _level;
+    Bits _crates;
+    Position _playerPosition{0, 0};
+    bool _hasPlayer{false};
+    unsigned int _moveCount{0};
+    unsigned int _pushCount{0};
+    MoveJournal _journal;
+    // scratch space of isDeadlocked() and canReach(), kept to avoid allocating
+    mutable Bits _scratch[4];
+    mutable Bits _reach;
+    mutable bool _reachValid{false};
+
+    static bool _test(const Bits& bits, size_t i) { return bits[i / 64] >> (i % 64) & 1; }
+    static void _set(Bits* bits, size_t i) { (*bits)[i / 64] |= uint64_t(1) << (i % 64); }
+    static void _clear(Bits* bits, size_t i) { (*bits)[i / 64] &= ~(uint64_t(1) << (i % 64)); }
+
+    // moves the player without recording it, returns false for an illegal move
+    bool _step(Direction dir, bool* push);
+};
+}  // namespace SB
@@ -0,0 +1,177 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sstream>  // for reading in the level file
+
+#include "sokoban/CheckpointHistory.hpp"
+#include "sokoban/LevelAnalysis.hpp"
+#include "sokoban/TileType.hpp"
+#include "sokoban/MoveJournal.hpp"
+
+namespace SB {
+// The game rules without any rendering: the board is stored as one TileType
+// per cell, so it can be copied and simulated without SFML or textures.
+class Board {
+ public:
+    Board() = default;
+    // builds a level from width * height tiles in row-major order, as read from a level file.
+    // The tiles cannot show a storage location under the player, so playerOnGoal adds it.
+    Board(unsigned int width, unsigned int height, const TileType* cells,
+          bool playerOnGoal = false);
+    // builds a level whose storage locations, crates and player are already
+    // known as cell indices, like in a level pack, so the tiles are not scanned.
+    // player is UINT32_MAX if there is none; throws for indices off the board.
+    Board(unsigned int width, unsigned int height, const TileType* cells,
+          const uint32_t* goals, size_t goalCount, const uint32_t* crates, size_t crateCount,
+          uint32_t player);
+
+    // returns the dimensions of the game board
+    unsigned int height() const { return _height; }
+    unsigned int width() const { return _width; }
+    size_t size() const { return _cells.size(); }
+
+    // returns the tile at the given cell, in row-major order
+    TileType at(unsigned int x, unsigned int y) const { return _cells[y * _width + x]; }
+    TileType operator[](size_t i) const { return _cells[i]; }
+
+    // returns the player's current position, with (0, 0) as the top-left corner
+    Position playerLoc() const;
+    size_t playerIndex() const { return _playerPosition.y * _width + _playerPosition.x; }
+    bool hasPlayer() const { return _hasPlayer; }
+
+    // returns the direction of the player's last move
+    Direction playerDirection() const { return _playerDirection; }
+
+    // returns true if a crate has to be pushed onto this cell
+    bool isStorageLocation(Position pos) const { return _goals[pos.y * _width + pos.x]; }
+    bool isStorageLocation(size_t i) const { return _goals[i]; }
+
+    // dead squares and push distances of the level, computed when it was loaded
+    const LevelAnalysis& analysis() const { return _analysis; }
+
+    // the crate and storage totals, and how many crates sit on storage
+    unsigned int boxCount() const { return _boxCount; }
+    unsigned int storageCount() const { return _storageCount; }
+    unsigned int matchedCount() const { return _matchedCount; }
+
+    // returns true if the player has won the game
+    bool isWon() const;
+
+    // takes a Direction and moves the player in that direction,
+    // returns false if the player could not move. Crates that can no longer
+    // reach a goal, or never move again, turn into their locked tiles.
+    bool movePlayer(Direction dir);
+
+    // returns true if the player can walk to the cell without pushing a
+    // crate. Answered from a flood fill that is only redone after a push.
+    bool canReach(Position pos) const;
+    // walks the shortest path to the cell as one undoable move, returns false
+    // without moving if the crates block every path. moves gets the LURD letters.
+    bool walkTo(Position target, std::string* moves = nullptr);
+    // pushes the crate to the target with the fewest pushes, walking between
+    // them, as one undoable move. The other crates stay where they are.
+    bool pushTo(Position crate, Position target, std::string* moves = nullptr);
+
+    // Get the current move count
+    unsigned int getMoveCount() const { return _moveCount; }
+    // the moves that pushed a crate
+    unsigned int getPushCount() const { return _pushCount; }
+
+    // changing game state
+    void reset();
+    void undo();
+    void redo();
+    // goes to the position after the given number of moves, anywhere from
+    // firstMove() to lastMove(). Returns false without moving outside that range.
+    bool jumpTo(size_t move);
+    // the move numbers undo() and redo() can reach
+    size_t firstMove() const;
+    size_t lastMove() const;
+
+    // the cells whose tile changed in the last movePlayer(), undo() or redo(),
+    // lets a view redraw only those. May hold a cell more than once.
+    const std::vector<size_t>& changedCells() const { return _changed; }
+
+    // the undo history, at most historyLimit() moves can be undone
+    const MoveJournal& history() const { return _journal; }
+    size_t historyLimit() const { return _journal.limit(); }
+    void setHistoryLimit(size_t limit) { _journal.setLimit(limit); }
+    // keeps every move of the session in at most bytes of checkpoints and
+    // packed moves, so undo() and jumpTo() reach past historyLimit(). Starts
+    // from the current position; 0 turns it off.
+    void setHistoryBudget(size_t bytes);
+    const CheckpointHistory& archive() const { return _archive; }
+
+    friend std::ostream& operator<<(std::ostream& out, const Board& b);
+    friend std::istream& operator>>(std::istream& in, Board& b);
+
+ private:
+    MoveJournal _journal;
+    CheckpointHistory _archive;
+    LevelAnalysis _analysis;
+    std::vector<TileType> _initialBoard;
+    std::vector<TileType> _cells;
+    std::vector<bool> _goals;  // one bit per cell, set on storage locations
+    Position _initialPlayerPosition{0, 0};
+    Position _playerPosition{0, 0};
+    bool _hasPlayer{false};
+    Direction _playerDirection{Direction::Down};
+    unsigned int _height{0};
+    unsigned int _width{0};
+    unsigned int _moveCount{0};
+    unsigned int _pushCount{0};
+    unsigned int _boxCount{0};
+    unsigned int _storageCount{0};
+    unsigned int _initialMatchedCount{0};
+    unsigned int _matchedCount{0};  // crates on storage, kept up to date by every move
+    std::vector<size_t> _lockQueue;  // scratch space of _relock, kept to avoid allocating
+    std::vector<uint32_t> _lockSeen;  // _lockStamp on the cells _relock queued
+    uint32_t _lockStamp{0};
+    std::vector<size_t> _changed;
+    // last step into every cell the player reaches from _reachOrigin, the
+    // origin is NO_ORIGIN once a push made the flood fill stale
+    static constexpr uint8_t UNSEEN = 0xff;
+    static constexpr size_t NO_ORIGIN = SIZE_MAX;
+    mutable std::vector<uint8_t> _reach;
+    mutable size_t _reachOrigin{NO_ORIGIN};
+    mutable std::vector<size_t> _floodQueue;
+
+    // sets up goals, counts, the analysis and the initial state from _cells
+    void _load(bool playerOnGoal = false);
+    // sets up the analysis once _cells and _goals are known
+    void _analyse();
+    // makes the current tiles the initial state, with empty histories
+    void _start();
+    // applies a move without touching the history, fills in what changed
+    bool _step(Direction dir, MoveJournal::Step* step);
+    // reverts a move recorded by _step
+    void _unstep(const MoveJournal::Step& step);
+    // refreshes the locked tiles after a crate moved between the two cells
+    void _relock(size_t from, size_t to);
+    // picks the crate tile of this cell from its goal and lock state
+    void _updateLock(size_t cell);
+    // floods from start over the cells the player can walk, as if the crate
+    // on freed stood on blocked instead; dirs gets the last step into each cell
+    void _flood(size_t start, size_t freed, size_t blocked, std::vector<uint8_t>* dirs) const;
+    // appends the walk from the start of the flood that filled dirs to cell
+    void _walk(const std::vector<uint8_t>& dirs, size_t start, size_t cell,
+               std::vector<Direction>* path) const;
+    // applies the moves as one undoable move, the path must be legal
+    void _applyPath(const std::vector<Direction>& path, std::string* moves);
+    // adds the move that was just made to the archive
+    void _archiveMove(Direction dir);
+    // the crates and player for an archive checkpoint
+    CheckpointHistory::Checkpoint _snapshot() const;
+    // sets up the position of a checkpoint taken after move
+    void _restore(const CheckpointHistory::Checkpoint& checkpoint, size_t move);
+};
+
+std::ostream& operator<<(std::ostream& out, const Board& b);
+std::istream& operator>>(std::istream& in, Board& b);
+}  // namespace SB
@@ -0,0 +1,79 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "sokoban/TileType.hpp"
+
+namespace SB {
+// The move sequence of a long session in two bits per move, with a snapshot
+// of the crates every interval() moves. Any stored move number is one
+// checkpoint restore plus at most interval() - 1 replayed moves away. Once
+// the memory budget is reached the checkpoints are thinned out, up to
+// MAX_INTERVAL moves apart, and then the oldest moves are forgotten.
+class CheckpointHistory {
+ public:
+    // the position after some number of moves
+    struct Checkpoint {
+      std::vector<uint32_t> crates;  // cells holding a crate
+      uint32_t player{0};
+      Direction direction{Direction::Down};
+      unsigned int pushes{0};
+    };
+
+    static const size_t MIN_INTERVAL = 64;
+    static const size_t MAX_INTERVAL = 4096;
+
+    CheckpointHistory() = default;
+    // budget is in bytes, cells is the board size; larger boards start with
+    // checkpoints further apart so taking them stays cheap per move
+    CheckpointHistory(size_t budget, size_t cells);
+
+    bool enabled() const { return _budget > 0; }
+    size_t budget() const { return _budget; }
+    size_t interval() const { return _interval; }
+    size_t memoryUsage() const { return _moves.size() + _checkpointBytes; }
+
+    // forgets everything and starts over from the position after move
+    void start(size_t move, Checkpoint checkpoint);
+
+    // the move numbers that can be reached, from first() to size() inclusive
+    size_t first() const { return _first; }
+    size_t size() const { return _size; }
+
+    // stores the move leading from move to move + 1, dropping the moves
+    // after it. Returns true if a checkpoint is due after the new move.
+    bool record(size_t move, Direction dir);
+    // stores the position after move, only call it when record() asked for it
+    void addCheckpoint(Checkpoint checkpoint);
+
+    // the move leading from move to move + 1
+    Direction direction(size_t move) const {
+        size_t i = move - _first;
+        return static_cast<Direction>(_moves[i / 4] >> (i % 4 * 2) & 3);
+    }
+    // the last checkpoint at or before move, at is set to its move number
+    const Checkpoint& checkpoint(size_t move, size_t* at) const;
+
+ private:
+    size_t _budget{0};
+    size_t _interval{MIN_INTERVAL};
+    size_t _first{0};  // move number of the first checkpoint
+    size_t _size{0};
+    std::deque<uint8_t> _moves;  // four moves per byte from _first on
+    // checkpoint i holds the position after move _first + i * _interval
+    std::deque<Checkpoint> _checkpoints;
+    size_t _checkpointBytes{0};
+
+    static size_t _bytes(const Checkpoint& checkpoint) {
+        return sizeof(Checkpoint) + checkpoint.crates.capacity() * sizeof(uint32_t);
+    }
+    // thins out the checkpoints or drops the oldest moves until the budget holds
+    void _trim();
+};
+}  // namespace SB
@@ -0,0 +1,208 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "sokoban/Board.hpp"
+#include "sokoban/MoveJournal.hpp"
+#include "sokoban/TileType.hpp"
+
+namespace SB {
+// The game rules for levels that fit a grid of W x H cells known at compile
+// time. Walls, goals and crates are fixed-size bitsets and the neighbour
+// offsets are constants, so a position is a few cache lines with no heap
+// allocation; only the history grows on the heap. Moves, undo and redo behave
+// like Board's, and cells are numbered in the level's own row-major order.
+template <unsigned int W, unsigned int H>
+class FixedBoard {
+ public:
+    static_assert(W >= 2 && H >= 1 && W * H <= 65536, "unsupported grid size");
+    static constexpr size_t SIZE = static_cast<size_t>(W) * H;
+    static constexpr size_t WORDS = (SIZE + 63) / 64;
+
+    // A level fits if it is at most H rows high and narrower than W: the
+    // spare column is walled, so a step off either side lands on a wall.
+    static bool fits(const Board& board) { return board.width() < W && board.height() <= H; }
+
+    FixedBoard() = default;
+    // takes the level and the current position from the board, throws
+    // std::runtime_error if it does not fit
+    explicit FixedBoard(const Board& board) {
+        if (!fits(board)) {
+            throw std::runtime_error("Level does not fit the fixed board");
+        }
+        _width = board.width();
+        _height = board.height();
+        _walls.fill(~uint64_t(0));
+        for (size_t i = 0; i < board.size(); i++) {
+            size_t cell = _cell(i);
+            if (board[i] != TileType::WALLS) {
+                _clear(&_walls, cell);
+            }
+            if (board.isStorageLocation(i)) {
+                _set(&_goals, cell);
+            }
+            if (SB::isCrate(board[i])) {
+                _set(&_initialCrates, cell);
+            }
+        }
+        _crateCount = board.boxCount();
+        _goalCount = board.storageCount();
+        _hasPlayer = board.hasPlayer();
+        if (_hasPlayer) {
+            _initialPlayer = static_cast<uint16_t>(_cell(board.playerIndex()));
+        }
+        reset();
+    }
+
+    unsigned int height() const { return _height; }
+    unsigned int width() const { return _width; }
+    size_t size() const { return static_cast<size_t>(_width) * _height; }
+
+    bool isWall(size_t i) const { return _test(_walls, _cell(i)); }
+    bool isGoal(size_t i) const { return _test(_goals, _cell(i)); }
+    bool isCrate(size_t i) const { return _test(_crates, _cell(i)); }
+
+    Position playerLoc() const {
+        if (!_hasPlayer) {
+            throw std::runtime_error("No player found");
+        }
+        return {static_cast<unsigned int>(_player % W), static_cast<unsigned int>(_player / W)};
+    }
+    size_t playerIndex() const { return (_player / W) * _width + _player % W; }
+
+    bool isWon() const {
+        if (_goalCount == 0 || _crateCount == 0) {
+            return true;
+        }
+        // every goal holds a crate, or every crate sits on a goal if there are fewer crates
+        uint64_t missing = 0;
+        for (size_t i = 0; i < WORDS; i++) {
+            missing |= _crateCount >= _goalCount ? _goals[i] & ~_crates[i] : _crates[i] & ~_goals[i];
+        }
+        return missing == 0;
+    }
+
+    bool movePlayer(Direction dir) {
+        bool push;
+        if (!_step(dir, &push)) {
+            return false;
+        }
+        _moveCount++;
+        _pushCount += push;
+        // undo only moves bits, so the tiles of the step are not needed
+        _journal.record(MoveJournal::Step::make(dir, dir, push, TileType::GROUNDS, TileType::GROUNDS));
+        return true;
+    }
+    unsigned int getMoveCount() const { return _moveCount; }
+    unsigned int getPushCount() const { return _pushCount; }
+
+    void reset() {
+        _crates = _initialCrates;
+        _player = _initialPlayer;
+        _moveCount = 0;
+        _pushCount = 0;
+        _journal.clear();
+    }
+
+    void undo() {
+        if (!_journal.canUndo()) {
+            return;
+        }
+        const MoveJournal::Step& step = _journal.undo();
+        size_t offset = OFFSETS[static_cast<int>(step.direction())];
+        size_t from = _player;
+        if (step.isPush()) {
+            _clear(&_crates, from + offset);
+            _set(&_crates, from);
+        }
+        _player = static_cast<uint16_t>(from - offset);
+        _moveCount--;
+        _pushCount -= step.isPush();
+    }
+
+    void redo() {
+        if (!_journal.canRedo()) {
+            return;
+        }
+        bool push;
+        _step(_journal.redo().direction(), &push);
+        _moveCount++;
+        _pushCount += push;
+    }
+
+    const MoveJournal& history() const { return _journal; }
+    void setHistoryLimit(size_t limit) { _journal.setLimit(limit); }
+
+ private:
+    using Bits = std::array<uint64_t, WORDS>;
+    // steps of one cell in Direction order; above the first row they wrap
+    // around to values past SIZE
+    static constexpr size_t OFFSETS[4] = {static_cast<size_t>(-static_cast<long>(W)), W,
+                                          static_cast<size_t>(-1), 1};
+
+    unsigned int _width{0};
+    unsigned int _height{0};
+    unsigned int _crateCount{0};
+    unsigned int _goalCount{0};
+    Bits _walls{};
+    Bits _goals{};
+    Bits _crates{};
+    Bits _initialCrates{};
+    uint16_t _player{0};
+    uint16_t _initialPlayer{0};
+    bool _hasPlayer{false};
+    unsigned int _moveCount{0};
+    unsigned int _pushCount{0};
+    MoveJournal _journal;
+
+    // the grid cell of a cell in the level's own numbering
+    size_t _cell(size_t i) const { return (i / _width) * W + i % _width; }
+
+    static bool _test(const Bits& bits, size_t i) { return bits[i / 64] >> (i % 64) & 1; }
+    static void _set(Bits* bits, size_t i) { (*bits)[i / 64] |= uint64_t(1) << (i % 64); }
+    static void _clear(Bits* bits, size_t i) { (*bits)[i / 64] &= ~(uint64_t(1) << (i % 64)); }
+
+    // moves the player without recording it, returns false for an illegal move
+    bool _step(Direction dir, bool* push) {
+        if (!_hasPlayer) {
+            throw std::runtime_error("No player found");
+        }
+        size_t offset = OFFSETS[static_cast<int>(dir)];
+        size_t next = _player + offset;
+        if (next >= SIZE || _test(_walls, next)) {
+            return false;
+        }
+        *push = _test(_crates, next);
+        if (*push) {
+            size_t to = next + offset;
+            if (to >= SIZE || _test(_walls, to) || _test(_crates, to)) {
+                return false;
+            }
+            _clear(&_crates, next);
+            _set(&_crates, to);
+        }
+        _player = static_cast<uint16_t>(next);
+        return true;
+    }
+};
+
+// Calls f once with the level as the smallest FixedBoard it fits, or with
+// the Board itself if it is too large for any of them. Dispatching once at
+// load time lets f run on a compile-time grid for the rest of the level.
+template <typename F>
+auto withFixedBoard(const Board& board, F&& f) {
+    if (FixedBoard<16, 16>::fits(board)) {
+        return f(FixedBoard<16, 16>(board));
+    }
+    if (FixedBoard<32, 32>::fits(board)) {
+        return f(FixedBoard<32, 32>(board));
+    }
+    return f(board);
+}
+}  // namespace SB
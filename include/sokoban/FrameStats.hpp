@@ -0,0 +1,40 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <chrono>
+#include <ctime>
+#include <string>
+
+namespace SB {
+// Frame times and the process' CPU usage over a reporting window, so an idle
+// game can be checked to really be idle.
+class FrameStats {
+ public:
+    FrameStats() { _restart(); }
+
+    // records one rendered frame that took this many seconds to produce
+    void frame(double seconds);
+
+    // returns true once the window is at least this many seconds long
+    bool due(double seconds) const { return _elapsed() >= seconds; }
+
+    // describes the window and starts a new one
+    std::string report();
+
+    size_t frames() const { return _frames; }
+
+ private:
+    std::chrono::steady_clock::time_point _start;
+    std::clock_t _cpuStart{0};
+    size_t _frames{0};
+    double _total{0};
+    double _longest{0};
+
+    double _elapsed() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+    }
+    void _restart();
+};
+}  // namespace SB
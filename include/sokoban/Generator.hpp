@@ -0,0 +1,60 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "sokoban/Board.hpp"
+#include "sokoban/Solver.hpp"
+#include "sokoban/ThreadPool.hpp"
+
+namespace SB {
+struct GeneratorOptions {
+    // size of the level including the outer walls
+    unsigned int width{9};
+    unsigned int height{9};
+    unsigned int crates{3};
+    // chance of an inner cell becoming a wall, from 0 to 1
+    double wallDensity{0.2};
+    // crates are pulled this many times away from the goals
+    unsigned int pulls{40};
+    uint64_t seed{1};
+
+    // a level is kept if its optimal solution and its branching fall in these ranges
+    unsigned int minPushes{6};
+    unsigned int maxPushes{UINT32_MAX};
+    unsigned int minMoves{0};
+    // average number of pushes that do not lose the level, over the solution's states
+    double minBranching{1.5};
+
+    // search limit per candidate, harder candidates are thrown away
+    size_t maxNodes{200000};
+    // stops after this many candidates even if not enough levels were kept, 0 for no limit
+    size_t maxCandidates{0};
+};
+
+struct GeneratedLevel {
+    Board board;
+    Solution solution;
+    double branching{0};
+    uint64_t candidate{0};  // generateLevel(options, candidate) builds the level again
+};
+
+// Builds one candidate: a random room with goals, solved and then played
+// backwards by pulling crates off their goals. Returns false if the candidate
+// misses the target difficulty. The same options and candidate number always
+// give the same level.
+bool generateLevel(const GeneratorOptions& options, uint64_t candidate, GeneratedLevel* level);
+
+// Runs candidates on the pool until count levels were kept or maxCandidates
+// were tried. Levels come back in candidate order, so a run is reproducible
+// whatever the number of threads.
+std::vector<GeneratedLevel> generateLevels(const GeneratorOptions& options, size_t count,
+                                           ThreadPool& pool, size_t* candidates = nullptr);
+
+// average number of pushes that do not move a crate onto a dead square, over
+// the states a solution passes through before each push
+double pushBranching(const Board& board, const std::string& moves);
+}  // namespace SB
@@ -0,0 +1,101 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "sokoban/TileType.hpp"
+
+namespace SB {
+// Facts about a level that only depend on its walls and goals, computed once
+// when the level is loaded. Cells are indexed in row-major order, like Board.
+class LevelAnalysis {
+ public:
+    static constexpr uint32_t UNREACHABLE = UINT32_MAX;
+    static constexpr size_t NO_CELL = SIZE_MAX;
+    // isFrozen() follows at most this many crates in a row, so crates
+    // further apart never change each other's result
+    static constexpr size_t MAX_CHAIN = 16;
+
+    LevelAnalysis() = default;
+    LevelAnalysis(unsigned int width, unsigned int height,
+                  const std::vector<TileType>& cells, const std::vector<bool>& goals);
+
+    // returns the neighbouring cell in the given direction, or NO_CELL off the board
+    size_t neighbor(size_t cell, Direction dir) const;
+
+    // pushes needed to bring a crate from this cell to the nearest goal,
+    // ignoring every other crate
+    uint32_t pushDistance(size_t cell) const { return _pushDistance[cell]; }
+    // returns true if a crate on this cell can never reach a goal
+    bool isDeadSquare(size_t cell) const { return _pushDistance[cell] == UNREACHABLE; }
+
+    // returns true if the crate on this cell can no longer be pushed along
+    // either axis, or only onto dead squares. isCrate(cell) tells where the
+    // other crates are, so any board representation can be checked.
+    template <typename IsCrate>
+    bool isFrozen(size_t cell, const IsCrate& isCrate) const {
+        Chain chain;
+        return _frozen(cell, isCrate, &chain);
+    }
+
+ private:
+    // crates already on the recursion path count as walls, this also keeps
+    // the check from running in circles
+    struct Chain {
+      static constexpr size_t CAPACITY = MAX_CHAIN;
+      size_t cells[CAPACITY];
+      size_t size{0};
+      unsigned int budget{256};  // gives up on large clusters rather than being slow
+
+      bool contains(size_t cell) const {
+          for (size_t i = 0; i < size; i++) {
+              if (cells[i] == cell) {
+                  return true;
+              }
+          }
+          return false;
+      }
+    };
+
+    unsigned int _width{0};
+    unsigned int _height{0};
+    std::vector<uint8_t> _walls;
+    std::vector<uint32_t> _pushDistance;
+
+    void _computePushDistance(const std::vector<bool>& goals);
+
+    template <typename IsCrate>
+    bool _frozen(size_t cell, const IsCrate& isCrate, Chain* chain) const {
+        // running out of room only ever misses a frozen crate, never invents one
+        if (chain->size == Chain::CAPACITY || chain->budget == 0) {
+            return false;
+        }
+        chain->budget--;
+        chain->cells[chain->size++] = cell;
+        bool frozen = _blocked(cell, Direction::Left, Direction::Right, isCrate, chain) &&
+                      _blocked(cell, Direction::Up, Direction::Down, isCrate, chain);
+        chain->size--;
+        return frozen;
+    }
+
+    template <typename IsCrate>
+    bool _blocked(size_t cell, Direction one, Direction other,
+                  const IsCrate& isCrate, Chain* chain) const {
+        size_t a = neighbor(cell, one);
+        size_t b = neighbor(cell, other);
+        auto solid = [&](size_t n) { return n == NO_CELL || _walls[n] || chain->contains(n); };
+        if (solid(a) || solid(b)) {
+            return true;
+        }
+        if (isDeadSquare(a) && isDeadSquare(b)) {
+            return true;
+        }
+        return (isCrate(a) && _frozen(a, isCrate, chain)) ||
+               (isCrate(b) && _frozen(b, isCrate, chain));
+    }
+};
+}  // namespace SB
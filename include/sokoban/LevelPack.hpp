@@ -0,0 +1,62 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "sokoban/Batch.hpp"
+#include "sokoban/Board.hpp"
+
+namespace SB {
+// One level of a pack, pointing straight into the mapped file
+struct PackedLevel {
+    std::string_view name;
+    unsigned int width;
+    unsigned int height;
+    const TileType* cells;   // width * height tiles in row-major order
+    const uint32_t* goals;   // cell indices of the storage locations
+    size_t goalCount;
+    const uint32_t* crates;  // cell indices of the crates
+    size_t crateCount;
+    uint32_t player;         // cell index of the player, NO_PLAYER if there is none
+
+    static constexpr uint32_t NO_PLAYER = UINT32_MAX;
+};
+
+// Many levels compiled into one binary file: a header, an index with one
+// entry per level, then the packed boards with their goal and crate lists.
+// The file is memory-mapped, so opening any level is O(1) and nothing is parsed.
+class LevelPack {
+ public:
+    static constexpr uint32_t VERSION = 1;
+
+    // throws std::runtime_error if the file is missing or not a level pack
+    explicit LevelPack(const std::string& filename);
+    ~LevelPack();
+
+    LevelPack(const LevelPack&) = delete;
+    LevelPack& operator=(const LevelPack&) = delete;
+
+    size_t size() const { return _count; }
+
+    // throws std::out_of_range for a bad index, std::runtime_error for a damaged pack
+    PackedLevel level(size_t i) const;
+    Board board(size_t i) const;
+
+    // compiles the levels into a pack file
+    static void write(const std::string& filename, const std::vector<BatchLevel>& levels);
+
+ private:
+    const unsigned char* _data{nullptr};
+    size_t _size{0};
+    size_t _count{0};
+    bool _mapped{false};  // false if the file was read into memory instead
+
+    void _close();
+};
+}  // namespace SB
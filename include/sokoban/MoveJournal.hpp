@@ -0,0 +1,82 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "sokoban/TileType.hpp"
+
+namespace SB {
+// Undo/redo history stored as one small delta per move instead of a copy of
+// the board. Entries live in a ring buffer, so once the limit is reached the
+// oldest moves are forgotten and memory stays bounded.
+class MoveJournal {
+ public:
+    // what a single move changed, enough to undo it without a snapshot
+    struct Step {
+      // bits 0-1 direction, bit 2 push, bits 3-4 previous direction, bit 5 joined
+      std::uint8_t flags;
+      TileType entered;    // the tile the player stepped onto
+      TileType covered;    // the tile the pushed crate was moved onto
+
+      Direction direction() const { return static_cast<Direction>(flags & 3); }
+      Direction previousDirection() const { return static_cast<Direction>((flags >> 3) & 3); }
+      bool isPush() const { return flags & 4; }
+      // a joined step is undone and redone together with the step before it
+      bool isJoined() const { return flags & JOINED; }
+
+      static const std::uint8_t JOINED = 32;
+
+      static Step make(Direction dir, Direction previous, bool push,
+                       TileType entered, TileType covered) {
+          return {static_cast<std::uint8_t>(static_cast<int>(dir) |
+                                            (push ? 4 : 0) |
+                                            (static_cast<int>(previous) << 3)),
+                  entered, covered};
+      }
+    };
+
+    static const size_t DEFAULT_LIMIT = 1 << 20;
+
+    explicit MoveJournal(size_t limit = DEFAULT_LIMIT) : _limit(limit ? limit : 1) {}
+
+    // records a new move, dropping any moves that could have been redone
+    void record(const Step& step);
+
+    bool canUndo() const { return _cursor > 0; }
+    bool canRedo() const { return _cursor < _size; }
+
+    // steps back over the last move and returns it
+    const Step& undo();
+    // steps forward over the next undone move and returns it
+    const Step& redo();
+    // the move redo() would return next
+    const Step& next() const { return _at(_cursor); }
+
+    // forgets every move
+    void clear() { _head = _size = _cursor = 0; }
+
+    // the number of moves that can be undone / redone
+    size_t undoCount() const { return _cursor; }
+    size_t redoCount() const { return _size - _cursor; }
+
+    // the maximum number of moves kept, older moves are dropped
+    size_t limit() const { return _limit; }
+    void setLimit(size_t limit);
+
+ private:
+    std::vector<Step> _entries;
+    size_t _limit;
+    size_t _head{0};    // index of the oldest move
+    size_t _size{0};    // moves stored, including undone ones
+    size_t _cursor{0};  // moves currently applied
+
+    const Step& _at(size_t offset) const {
+      size_t i = _head + offset;
+      return _entries[i >= _limit ? i - _limit : i];
+    }
+};
+}  // namespace SB
@@ -0,0 +1,77 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace SB {
+// Latency histograms for named phases of the main loop. Each sample costs two
+// clock reads and a few additions, so it can stay on in a shipped game.
+class Profiler {
+ public:
+    // bucket 0 holds samples under 1 us, bucket b holds [2^(b-1), 2^b) us
+    static const size_t BUCKETS = 32;
+
+    struct Phase {
+      std::string name;
+      size_t count{0};
+      double total{0};
+      double longest{0};
+      std::array<size_t, BUCKETS> buckets{};
+
+      double average() const { return count ? total / count : 0; }
+      // upper bound in seconds of the bucket holding the p-th fraction of samples
+      double percentile(double p) const;
+    };
+
+    // times one run of a phase, does nothing while the profiler is off
+    class Scope {
+     public:
+        Scope(Profiler& profiler, size_t phase)
+            : _profiler(profiler.enabled() ? &profiler : nullptr), _phase(phase) {
+            if (_profiler) {
+                _start = std::chrono::steady_clock::now();
+            }
+        }
+        ~Scope() {
+            if (_profiler) {
+                _profiler->record(_phase, std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - _start).count());
+            }
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+     private:
+        Profiler* _profiler;
+        size_t _phase;
+        std::chrono::steady_clock::time_point _start;
+    };
+
+    // registers a phase and returns its id for record() and Scope
+    size_t add(const std::string& name);
+    void record(size_t phase, double seconds);
+
+    bool enabled() const { return _enabled; }
+    void setEnabled(bool enabled) { _enabled = enabled; }
+
+    size_t size() const { return _phases.size(); }
+    const Phase& phase(size_t id) const { return _phases[id]; }
+
+    // one short line per phase, for an on-screen overlay
+    std::string overlay() const;
+    // every phase with its full histogram
+    void write(std::ostream& out) const;
+    // forgets every sample, keeps the phases
+    void clear();
+
+ private:
+    std::vector<Phase> _phases;
+    bool _enabled{true};
+};
+}  // namespace SB
@@ -0,0 +1,67 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "sokoban/Board.hpp"
+#include "sokoban/MoveJournal.hpp"
+
+namespace SB {
+// Records a session as a LURD string with the time of every move, in
+// milliseconds since the session started. Undone moves are kept until a new
+// move replaces them, so the recording always replays to the current board.
+class MoveRecorder {
+ public:
+    MoveRecorder() { restart(); }
+
+    // forgets every move and starts the clock again
+    void restart();
+
+    void record(Direction dir, bool push);
+    void undo() { _cursor -= _cursor > 0; }
+    void redo() { _cursor += _cursor < _moves.size(); }
+
+    // the moves currently applied, in LURD notation
+    std::string moves() const { return _moves.substr(0, _cursor); }
+    // milliseconds since the start of the session, one per move
+    std::vector<unsigned long> times() const;
+
+    // writes "moves<TAB>time,time,..." on one line
+    friend std::ostream& operator<<(std::ostream& out, const MoveRecorder& recorder);
+
+ private:
+    // as many moves as the undo history keeps, recording more allocates
+    static const size_t RESERVED_MOVES = MoveJournal::DEFAULT_LIMIT;
+
+    std::chrono::steady_clock::time_point _start;
+    std::string _moves;
+    std::vector<uint32_t> _times;  // milliseconds, enough for 49 days
+    size_t _cursor{0};
+};
+
+struct ReplayResult {
+    size_t applied{0};       // letters applied before the replay stopped
+    unsigned int moves{0};   // getMoveCount() of the final board
+    unsigned int pushes{0};
+    bool won{false};
+    bool valid{true};        // false if a letter was illegal or had the wrong case
+
+    // returns true for a legal move string that wins the level
+    bool solved() const { return valid && won; }
+};
+
+// Applies a LURD string to the board without rendering. The replay stops at
+// the first letter that is not a legal move, or whose case does not match
+// whether it pushed a crate. Blanks and line breaks are skipped. The board is
+// left in its final state. It is instantiated for Board, BitBoard and the
+// FixedBoard sizes withFixedBoard() picks.
+template <typename B>
+ReplayResult replay(B* board, std::string_view moves);
+}  // namespace SB
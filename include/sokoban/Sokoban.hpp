@@ -3,7 +3,10 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>  // for the hash table, O(1) lookup, or O(n) for worst case
 #include <memory>  // for shared_ptr
@@ -16,70 +19,35 @@
 
 #include <SFML/Graphics.hpp>
 
-namespace SB { 
-enum class Direction {
-    Up, Down, Left, Right
-};
-
-/*
-*  Background: GROUNDS, HOLE, GROUND_OUTLINES
-*  Foreground: WALLS, OUTLINES, CRATES, HOLE_CRATES, LOCKED_CRATE,
-               DIM_CRATES, DIM_HOLE_CRATES, FALLING_CRATES, LOCKED_HOLE_CRATES,
-               COINS, PLAYER
-*/
-
-enum class TileType {
-    // ENVIRONMENT
-    PLAYER = '@',
-    GROUNDS = '.',
-    WALLS = '#',
-    CRATES = 'A',
-    HOLE = 'H',
-    COINS = 'C',
-
-    // LOSE
-    LOCKED_CRATE = 'L',
-
-    // GOAL
-    GROUND_OUTLINES = 'a',
-    OUTLINES = 'o',
-    DIM_CRATES = 'D',
-    DIM_HOLE_CRATES = 'd',
-    FALLING_CRATES = 'F',
-    HOLE_CRATES = '1',
-    LOCKED_HOLE_CRATES = 'l'
-};
+#include "sokoban/AssetCache.hpp"
+#include "sokoban/Board.hpp"
+#include "sokoban/Replay.hpp"
+#include "sokoban/TileAtlas.hpp"
+#include "sokoban/Trace.hpp"
 
+namespace SB {
 struct Tile {
     TileType type;
-    sf::Sprite sprite;
+    size_t frame;  // atlas id of the tile's image, see TileClassifier::region()
 };
 
-class Sokoban;
-
 class TileClassifier {
  public:
-    TileClassifier() : _textureHashTable(14) {
+    TileClassifier() {
+      // the tables keep atlas ids, the images are decoded in the background
+      // and a pixel of the fallback colour stands in until they arrive
+      auto loadImage = [&](TileType type, const std::string& filename) {
+         _images.push_back(AssetCache::instance().load<sf::Image>(filename));
+         _fallbackColors.push_back(_defaultHashTable.at(type));
+         return _images.size() - 1;
+      };
+
       auto classifyAnimation = [&](Direction dir, const std::string& filename) {
-         auto texture = std::make_shared<sf::Texture>();
-         std::string baseName = filename.substr(filename.find_last_of('/') + 1);
-         if (!texture->loadFromFile(filename) && !texture->loadFromFile("./" + baseName)) {
-            sf::Image image;
-            image.create(1, 1, _defaultHashTable.at(TileType::PLAYER));
-            texture->loadFromImage(image);
-         }
-         _animationHashTable[dir].push_back(texture);
+         _animations[static_cast<int>(dir)].push_back(loadImage(TileType::PLAYER, filename));
       };
 
       auto classifyTexture = [&](TileType type, const std::string& filename) {
-         auto texture = std::make_shared<sf::Texture>();
-         std::string baseName = filename.substr(filename.find_last_of('/') + 1);
-         if (!texture->loadFromFile(filename) && !texture->loadFromFile("./" + baseName)) {
-            sf::Image image;
-            image.create(1, 1, _defaultHashTable.at(type));
-            texture->loadFromImage(image);
-         }
-         _textureHashTable[type].push_back(texture);
+         _textures[tileIndex(type)].push_back(loadImage(type, filename));
       };
 
 
@@ -177,73 +145,87 @@ class TileClassifier {
       classifyTexture(TileType::GROUNDS, "assets/sokoban/Ground/ground_01.png");
       classifyTexture(TileType::GROUNDS, "assets/sokoban/Ground/ground_05.png");
       classifyTexture(TileType::GROUNDS, "assets/sokoban/Ground/ground_06.png");
-    }
 
-    Tile createTile(char c, std::shared_ptr<unsigned int> seed) const {
-         auto tileType = static_cast<TileType>(c);
-         if (tileType == TileType::PLAYER) {
-            return Tile {
-               tileType,
-               sf::Sprite(*((_animationHashTable.at(Direction::Down))[0]))
-            };
+      // DEFAULTS, built up front so that lookups never modify the tables
+      auto defaultTexture = [&](TileType type) {
+         _images.emplace_back();
+         _fallbackColors.push_back(_defaultHashTable.at(type));
+         return _images.size() - 1;
+      };
+      for (const auto& entry : _defaultHashTable) {
+         if (_textures[tileIndex(entry.first)].empty()) {
+            _textures[tileIndex(entry.first)] = {defaultTexture(entry.first)};
          }
-         // loads default if missing texture images
-         if (_textureHashTable.find(tileType) == _textureHashTable.end()) {
-            auto it = _defaultTextureHashTable.find(tileType);
-            if (it == _defaultTextureHashTable.end()) {
-               auto defaultTexture = std::make_shared<sf::Texture>();
-               sf::Image image;
-               image.create(1, 1, _defaultHashTable.at(tileType));
-               defaultTexture->loadFromImage(image);
-               _defaultTextureHashTable[tileType] = defaultTexture;
-            }
-            return Tile {
-               tileType,
-               sf::Sprite(*(_defaultTextureHashTable.at(tileType)))
-            };
+      }
+      for (std::vector<size_t>& frames : _animations) {
+         if (frames.empty()) {
+            auto texture = defaultTexture(TileType::PLAYER);
+            frames = {texture, texture, texture};
          }
+      }
+      // with a warm cache the images are already there
+      if (!update()) {
+         _buildAtlas();
+      }
+    }
+
+    Tile createTile(char c, std::shared_ptr<unsigned int> seed) const {
          unsigned int temp = *seed;
-         int random_index = rand_r(&temp) % (_textureHashTable.at(tileType)).size();
-         return Tile {
-            tileType,
-            sf::Sprite(*((_textureHashTable.at(tileType))[random_index]))
-         };
+         return createTile(c, static_cast<unsigned int>(rand_r(&temp)));
     }
 
-    Tile createTile(char c) const {
+    Tile createTile(char c) const { return createTile(c, 0u); }
+
+    // the tile with one of the textures of its type, picked by variant
+    Tile createTile(char c, unsigned int variant) const {
          auto tileType = static_cast<TileType>(c);
          if (tileType == TileType::PLAYER) {
             return Tile {
                tileType,
-               sf::Sprite(*((_animationHashTable.at(Direction::Down))[0]))
-            };
-         }
-         // loads default if missing texture images
-         if (_textureHashTable.find(tileType) == _textureHashTable.end()) {
-            auto it = _defaultTextureHashTable.find(tileType);
-            if (it == _defaultTextureHashTable.end()) {
-               auto defaultTexture = std::make_shared<sf::Texture>();
-               sf::Image image;
-               image.create(1, 1, _defaultHashTable.at(tileType));
-               defaultTexture->loadFromImage(image);
-               _defaultTextureHashTable[tileType] = defaultTexture;
-            }
-            return Tile {
-               tileType,
-               sf::Sprite(*(_defaultTextureHashTable.at(tileType)))
+               getAnimationFrames(Direction::Down)[0]
             };
          }
          return Tile {
             tileType,
-            sf::Sprite(*((_textureHashTable.at(tileType))[0]))
+            frame(tileType, variant)
          };
     }
 
-    inline static Tile getAnimation(Direction dir, std::shared_ptr<unsigned int> index);
+    // the atlas id of one of the type's textures, the variant wraps around.
+    // Types without a texture or default colour throw std::out_of_range.
+    size_t frame(TileType type, unsigned int variant) const {
+         const std::vector<size_t>& frames = _textures[tileIndex(type)];
+         if (frames.empty()) {
+            throw std::out_of_range("No texture for this tile type");
+         }
+         return frames[variant % frames.size()];
+    }
+
+    // the single texture holding every tile and animation frame
+    const sf::Texture& texture() const { return _atlas.texture(); }
+    const sf::IntRect& region(size_t frame) const { return _atlas.region(frame); }
+
+    // swaps in the decoded images once all of them arrived, returns true if
+    // it did. Tiles keep their frame, only the pixels behind it change.
+    bool update();
+    bool isLoaded() const { return _images.empty(); }
+    // true if the images did not fit the atlas, the tiles show their
+    // fallback colours instead
+    bool hasFailed() const { return _failed; }
+
+    // returns the next animation frame of the player, lastDir is the direction
+    // the player faced before this move
+    Tile getAnimation(Direction dir, Direction lastDir,
+                      const std::shared_ptr<unsigned int>& index) const;
+
+    // returns the atlas ids of the player's animation, defaults if missing
+    const std::vector<size_t>& getAnimationFrames(Direction dir) const {
+         return _animations[static_cast<int>(dir)];
+    }
 
  private:
     // containing default colors in case of missing texture
-    inline static std::unordered_map<TileType, sf::Color> _defaultHashTable {
+    inline static const std::unordered_map<TileType, sf::Color> _defaultHashTable {
       {TileType::PLAYER,               sf::Color::White},           // White
       {TileType::CRATES,               sf::Color::Yellow},          // Yellow
       {TileType::HOLE_CRATES,          sf::Color::Black},           // Black
@@ -260,41 +242,43 @@ class TileClassifier {
       {TileType::WALLS,                sf::Color(255, 215, 0)}      // Gold
     };
 
-    // containing textures for each animation
-    inline static std::unordered_map<Direction, std::vector<
-                                 std::shared_ptr<
-                                 sf::Texture>>> _animationHashTable{4};
+    // every texture below lives in this atlas
+    TileAtlas _atlas;
+    // one entry per atlas id until the images are in the atlas, an invalid
+    // handle means the id only ever shows its fallback colour
+    std::vector<AssetCache::Handle<sf::Image>> _images;
+    std::vector<sf::Color> _fallbackColors;
+    bool _failed{false};
 
-    // containing textures for each tile type
-    std::unordered_map<TileType, std::vector<
-                                 std::shared_ptr<
-                                 sf::Texture>>> _textureHashTable;
+    void _buildAtlas();
 
-    // containing default textures for tile types of missing texture
-    inline static std::unordered_map<TileType,
-                  std::shared_ptr<sf::Texture>> _defaultTextureHashTable;
+    // atlas ids of each animation, indexed by Direction; a direction
+    // without images gets a default one
+    std::array<std::vector<size_t>, 4> _animations;
 
-    // containing default animations for player of missing texture
-    inline static std::unordered_map<Direction, std::vector<
-                                 std::shared_ptr<
-                                 sf::Texture>>> _defaultAnimationHashTable;
+    // atlas ids of each tile type, indexed by tileIndex(); a type without
+    // images gets its default colour
+    std::array<std::vector<size_t>, TILE_TYPE_COUNT> _textures;
 };
 
 class Sokoban : public sf::Drawable {
  public:
     static const int TILE_SIZE = 64;
+    // bytes every level may spend on archived moves, so undo and jumpTo() go
+    // back to the start through a checkpoint instead of step by step
+    static const size_t HISTORY_BUDGET = 1 << 20;
 
     Sokoban();
     explicit Sokoban(std::shared_ptr<unsigned int> seed);  // to randomize the textures of the game
 
     explicit Sokoban(const std::string&);  // Optional
 
-    unsigned int pixelHeight() const { return _height * TILE_SIZE; }  // Optional
-    unsigned int pixelWidth() const { return _width * TILE_SIZE; }  // Optional
+    unsigned int pixelHeight() const { return height() * TILE_SIZE; }  // Optional
+    unsigned int pixelWidth() const { return width() * TILE_SIZE; }  // Optional
 
     // returns the dimensions of the game board
-    unsigned int height() const { return _height; }
-    unsigned int width() const { return _width; }
+    unsigned int height() const { return _board.height(); }
+    unsigned int width() const { return _board.width(); }
 
     // returns the floor tile
     Tile floor() const { return _floor; }
@@ -302,25 +286,53 @@ class Sokoban : public sf::Drawable {
     // returns the player's current position, with (0, 0) as the top-left corner
     sf::Vector2u playerLoc() const;
 
-    // saves the player's current position, with (0, 0) as the top-left corner
-    static void savePlayerLoc(sf::Vector2u position) { _playerPosition = position; }
-
-    // saves the player's current direction
-    static void savePlayerDirection(Direction dir) { _playerDirection = dir; }
-
     // returns true if the player has won the game
-    bool isWon() const;
+    bool isWon() const { return _board.isWon(); }
 
     // takes a Direction and moves the player in that direction
     void movePlayer(Direction dir);
+    // walks to the cell, or pushes the crate there, as one undoable move;
+    // see Board::walkTo and Board::pushTo
+    bool walkTo(Position target);
+    bool pushTo(Position crate, Position target);
 
     // Get the current move count
-    unsigned int getMoveCount() const { return _moveCount; }
+    unsigned int getMoveCount() const { return _board.getMoveCount(); }
+
+    // picks up textures that finished loading in the background, call it
+    // once per frame. Returns true if the board looks different now.
+    bool updateAssets();
+    // returns true once every texture finished loading
+    bool assetsLoaded() const { return _tileClassifier.isLoaded(); }
+    // returns true if the textures could not be used and plain colours are drawn
+    bool assetsFailed() const { return _tileClassifier.hasFailed(); }
+
+    // returns the game rules this view draws
+    const Board& board() const { return _board; }
+    // the moves of the current attempt with their times, restarted by reset()
+    const MoveRecorder& recording() const { return _recorder; }
+
+    // a level with everything load() needs that does not touch the GPU:
+    // parsed, analysed and with the texture variant of every cell picked
+    struct PreparedLevel {
+      Board board;
+      std::vector<uint8_t> variants;
+    };
+    // only reads its arguments, so the next level can be prepared on a
+    // worker thread while the current one is still played
+    static PreparedLevel prepare(Board board, unsigned int seed);
+
+    // starts a level that was already loaded, e.g. from a LevelPack
+    void load(const Board& board);
+    // starts a prepared level, only its render layers are built here
+    void load(PreparedLevel level);
 
     // changing game state
     void reset();
     void undo();  // Optional XC
     void redo();  // Optional XC
+    // goes to the position after the given number of moves, see Board::jumpTo
+    bool jumpTo(size_t move);
 
     friend std::ostream& operator<<(std::ostream& out, const Sokoban& s);
     friend std::istream& operator>>(std::istream& in, Sokoban& s);
@@ -330,70 +342,97 @@ class Sokoban : public sf::Drawable {
 
  private:
     TileClassifier _tileClassifier;
-    struct _gameState {
-      std::vector<Tile> gameBoard;
-      sf::Vector2u playerPosition;
-      Direction playerDirection;
-      unsigned int moveCount;
-    };
-    std::stack<_gameState> _stack;
-    std::stack<_gameState> _undoStack;
-    std::stack<_gameState> _redoStack;
-    std::vector<Tile> _initialBoard;
-    std::vector<Tile> _gameBoard;
-    inline static sf::Vector2u _playerPosition{0, 0};
-    static std::vector<sf::Vector2u> _storagePositions;
-    inline static Direction _playerDirection{Direction::Down};  // helps to draw the player
+    Board _board;
+    MoveRecorder _recorder;
+    // one tile per tile type for what moves, the texture is picked once from _seed
+    std::array<Tile, TILE_TYPE_COUNT> _tiles{};
+    // the texture variant of each cell's floor or wall, picked from _seed on load
+    std::vector<uint8_t> _variants;
     std::shared_ptr<unsigned int> _frameIndex = std::make_shared<unsigned int>(0);
     std::shared_ptr<unsigned int> _seed;
-    unsigned int _height;
-    unsigned int _width;
-    unsigned int _moveCount{0};
-    inline static unsigned int _boxCount{0};
     Tile _floor;  // helps to draw the floor of the level
-    Tile _outline;  // helps to draw the ground outlines
-
-    void _saveState() {
-      _stack.push({_gameBoard, _playerPosition, _playerDirection, _moveCount});
-    }
-    void _saveStateUndo() {
-      _undoStack.push({_gameBoard, _playerPosition, _playerDirection, _moveCount});
-    }
-    void _saveStateRedo() {
-      _redoStack.push({_gameBoard, _playerPosition, _playerDirection, _moveCount});
-    }
-
-    friend class TileClassifier;
+    Tile _player;  // the player's current animation frame
+    // walls and floors are rendered once per level into _staticLayer, the
+    // board layer copies them and only redraws the cells a move changed
+    sf::RenderTexture _staticLayer;
+    sf::RenderTexture _boardLayer;
+    bool _hasLayers{false};  // false if the level is too large for a render texture
+    mutable sf::VertexArray _vertices{sf::Triangles};
+    sf::VertexArray _background{sf::Triangles};  // scratch space of _renderCells()
+
+    void _loadTiles();
+    void _syncPlayer();
+    // records the LURD letters of a walk or push and redraws what it changed
+    void _recordPath(const std::string& moves);
+    // appends the tiles that never change on this cell
+    void _addStaticTiles(sf::VertexArray* vertices, unsigned int x, unsigned int y) const;
+    // appends the crate, player or item on this cell, if any
+    void _addDynamicTile(sf::VertexArray* vertices, unsigned int x, unsigned int y) const;
+    // creates both layers for a new level and renders them
+    void _renderLayers();
+    // redraws every dynamic tile of the board layer
+    void _renderBoard();
+    // redraws the given cells and the player's cell of the board layer
+    void _renderCells(const std::vector<size_t>& cells);
 };
 
 std::ostream& operator<<(std::ostream& out, const Sokoban& s);
 std::istream& operator>>(std::istream& in, Sokoban& s);
 
-inline Tile TileClassifier::getAnimation(Direction dir, std::shared_ptr<unsigned int> index) {
-    if (dir == Sokoban::_playerDirection) {
+inline void TileClassifier::_buildAtlas() {
+    Trace::Scope scope("build atlas", "assets");
+    TileAtlas atlas;
+    for (size_t i = 0; i < _images.size(); i++) {
+        std::shared_ptr<const sf::Image> image =
+            !_failed && isReady(_images[i]) ? _images[i].get() : nullptr;
+        if (image) {
+            atlas.add(*image);
+        } else {
+            sf::Image pixel;
+            pixel.create(1, 1, _fallbackColors[i]);
+            atlas.add(pixel);
+        }
+    }
+    if (!atlas.build()) {
+        if (_failed) {
+            return;
+        }
+        // only the decoded images can be too large, one pixel per id always fits
+        std::cerr << "Tile images do not fit in one texture, drawing plain colours instead" <<
+                     std::endl;
+        _failed = true;
+        _buildAtlas();
+        return;
+    }
+    _atlas = std::move(atlas);
+}
+
+inline bool TileClassifier::update() {
+    if (isLoaded()) {
+        return false;
+    }
+    for (const auto& image : _images) {
+        if (image.valid() && !isReady(image)) {
+            return false;
+        }
+    }
+    _buildAtlas();
+    _images.clear();
+    _fallbackColors.clear();
+    return true;
+}
+
+inline Tile TileClassifier::getAnimation(Direction dir, Direction lastDir,
+                                         const std::shared_ptr<unsigned int>& index) const {
+    if (dir == lastDir) {
          *index += 1;
     } else {
          *index = 1;
     }
-    // loads default if missing animation
-    if (_animationHashTable.find(dir) == _animationHashTable.end() ||
-        _animationHashTable.at(dir).empty()) {
-        if (_defaultAnimationHashTable.find(dir) == _defaultAnimationHashTable.end()) {
-            auto defaultTexture = std::make_shared<sf::Texture>();
-            sf::Image image;
-            image.create(1, 1, _defaultHashTable.at(TileType::PLAYER));
-            defaultTexture->loadFromImage(image);
-            // store it for default use
-            _defaultAnimationHashTable[dir] = {defaultTexture, defaultTexture, defaultTexture};
-        }
-        return Tile {
-            TileType::PLAYER,
-            sf::Sprite(*(_defaultAnimationHashTable.at(dir)[0]))
-        };
-    }
+    const auto& frames = getAnimationFrames(dir);
     return Tile {
          TileType::PLAYER,
-         sf::Sprite(*((_animationHashTable.at(dir))[(*index) % 3]))
+         frames[(*index) % frames.size()]
     };
 }
 }  // namespace SB
@@ -0,0 +1,131 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sokoban/Board.hpp"
+#include "sokoban/LevelAnalysis.hpp"
+
+namespace SB {
+struct SolverOptions {
+    enum class Algorithm { AStar, IDAStar };
+    enum class Objective { Moves, Pushes };
+
+    Algorithm algorithm{Algorithm::AStar};
+    Objective objective{Objective::Moves};
+    // 1 finds an optimal solution, above 1 the solution costs at most weight * optimal
+    double weight{1.0};
+    // transposition table entries, rounded up to a power of two
+    size_t tableSize{size_t(1) << 20};
+    // gives up after expanding this many states, 0 for no limit
+    size_t maxNodes{0};
+    // gives up after this many seconds, 0 for no limit
+    double timeLimit{0};
+    // gives up once the search holds about this many bytes, 0 for no limit
+    size_t maxMemory{0};
+};
+
+struct Solution {
+    enum class Status { Solved, Unsolvable, LimitReached, TimedOut, OutOfMemory };
+
+    Status status{Status::Unsolvable};
+    std::string moves;  // LURD, lowercase moves and uppercase pushes
+    unsigned int moveCount{0};
+    unsigned int pushCount{0};
+    size_t nodesExpanded{0};
+    bool optimal{false};  // true if no cheaper solution exists for the objective
+
+    bool solved() const { return status == Status::Solved; }
+};
+
+// returns a short lowercase name of the status for reports
+const char* toString(Solution::Status status);
+
+// Searches the pushes of a level for a solution. States are the crate
+// positions plus the player, hashed incrementally with Zobrist keys and
+// remembered in a fixed-size transposition table.
+class Solver {
+ public:
+    explicit Solver(const Board& board, SolverOptions options = SolverOptions());
+
+    Solution solve();
+
+ private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Node {
+      uint32_t parent;
+      uint32_t crate;  // cell of the pushed crate before the push, the player ends there
+      uint32_t g;
+      uint8_t dir;
+    };
+    struct Entry {
+      uint64_t key;
+      uint32_t g;
+      uint32_t stamp;
+    };
+    struct Push {
+      uint32_t crate;
+      uint8_t dir;
+      uint32_t cost;
+    };
+
+    SolverOptions _options;
+    // the board is padded with a ring of walls so neighbours never leave it
+    unsigned int _width{0};
+    unsigned int _height{0};
+    int _offsets[4];
+    std::vector<uint8_t> _walls;
+    std::vector<uint8_t> _goals;
+    std::vector<uint32_t> _pushDistance;  // pushes to the nearest goal, ignoring other crates
+    LevelAnalysis _analysis;
+    unsigned int _boardWidth{0};
+    std::vector<uint64_t> _crateKeys;
+    std::vector<uint64_t> _playerKeys;
+    std::vector<uint32_t> _startCrates;
+    uint32_t _startPlayer{0};
+    unsigned int _targets{0};  // crates that have to end on a goal
+    bool _alreadyWon{false};
+
+    // scratch space reused by every expansion
+    std::vector<uint8_t> _occupied;
+    std::vector<uint32_t> _reach;
+    std::vector<uint32_t> _reachStamp;
+    std::vector<uint32_t> _queue;
+    uint32_t _stamp{0};
+    uint32_t _reachMin{0};
+
+    std::vector<Entry> _table;
+    uint32_t _iteration{0};
+    size_t _expanded{0};
+    size_t _memory{0};  // bytes held by the search, besides the scratch space
+    std::chrono::steady_clock::time_point _deadline;
+    Solution::Status _limit{Solution::Status::Unsolvable};  // set once a limit stops the search
+
+    uint32_t _cell(unsigned int x, unsigned int y) const { return (y + 1) * _width + x + 1; }
+    void _flood(uint32_t player);
+    uint32_t _distance(uint32_t cell) const {
+      return _reachStamp[cell] == _stamp ? _reach[cell] : NONE;
+    }
+    uint32_t _heuristic(const uint32_t* crates) const;
+    bool _isSolved(const uint32_t* crates) const;
+    uint64_t _key(uint64_t crateKey, uint32_t player) const;
+    bool _visit(uint64_t key, uint32_t g);
+    void _pushes(const uint32_t* crates, std::vector<Push>* out) const;
+    // returns true if pushing the crate onto `to` leaves it frozen
+    bool _freezes(uint32_t crate, uint32_t to) const;
+    bool _limitReached();
+
+    Solution _aStar();
+    Solution _idaStar();
+    bool _idaSearch(std::vector<uint32_t>* crates, uint64_t crateKey, uint32_t player,
+                    uint32_t g, uint32_t bound, uint32_t* next,
+                    std::vector<std::pair<uint32_t, uint8_t>>* path);
+    Solution _finish(const std::vector<std::pair<uint32_t, uint8_t>>& path);
+};
+}  // namespace SB
@@ -0,0 +1,55 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SB {
+// Fixed set of workers, each with its own task deque. A worker takes its
+// newest task first and steals the oldest task of another worker when it runs
+// dry, so long levels never leave the other threads idle behind them.
+class ThreadPool {
+ public:
+    // 0 uses one thread per hardware thread
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return _threads.size(); }
+
+    void submit(std::function<void()> task);
+    // blocks until every submitted task finished, rethrows the first exception a task threw
+    void wait();
+
+ private:
+    struct Queue {
+      std::mutex mutex;
+      std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _idle;
+    std::atomic<size_t> _queued{0};
+    size_t _pending{0};
+    size_t _next{0};
+    bool _stopping{false};
+    std::exception_ptr _error;
+
+    void _run(size_t index);
+    bool _take(size_t index, std::function<void()>* task);
+};
+}  // namespace SB
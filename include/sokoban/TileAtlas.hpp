@@ -0,0 +1,35 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+namespace SB {
+// Packs many small images into one texture, so the whole board can be drawn
+// with a single texture bound. Images are added first, then build() uploads them.
+class TileAtlas {
+ public:
+    // adds an image and returns its id, the region is known once build() ran
+    size_t add(const sf::Image& image);
+
+    // packs every added image into the texture, returns false if it does not fit
+    bool build();
+
+    const sf::Texture& texture() const { return _texture; }
+    const sf::IntRect& region(size_t id) const { return _regions[id]; }
+    size_t size() const { return _regions.size(); }
+
+ private:
+    // every image is surrounded by a copy of its edge pixels, so scaled
+    // tiles never sample their neighbours in the atlas
+    static const unsigned int PADDING = 1;
+    static const unsigned int MAX_WIDTH = 2048;
+
+    std::vector<sf::Image> _images;  // dropped once uploaded
+    std::vector<sf::IntRect> _regions;
+    sf::Texture _texture;
+};
+}  // namespace SB
@@ -0,0 +1,107 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace SB {
+enum class Direction {
+    Up, Down, Left, Right
+};
+
+/*
+*  Background: GROUNDS, HOLE, GROUND_OUTLINES
+*  Foreground: WALLS, OUTLINES, CRATES, HOLE_CRATES, LOCKED_CRATE,
+               DIM_CRATES, DIM_HOLE_CRATES, FALLING_CRATES, LOCKED_HOLE_CRATES,
+               COINS, PLAYER
+*/
+
+// one byte per cell, the value is the character used in the level file
+enum class TileType : char {
+    // ENVIRONMENT
+    PLAYER = '@',
+    GROUNDS = '.',
+    WALLS = '#',
+    CRATES = 'A',
+    HOLE = 'H',
+    COINS = 'C',
+
+    // LOSE
+    LOCKED_CRATE = 'L',
+
+    // GOAL
+    GROUND_OUTLINES = 'a',
+    OUTLINES = 'o',
+    DIM_CRATES = 'D',
+    DIM_HOLE_CRATES = 'd',
+    FALLING_CRATES = 'F',
+    HOLE_CRATES = '1',
+    LOCKED_HOLE_CRATES = 'l'
+};
+
+// what the rules and the renderer need to know about a kind of tile
+struct TileTraits {
+    bool passable;    // the player can step onto it without pushing anything
+    bool pushable;    // holds a crate, locked or not
+    bool background;  // drawn once per level, a move never changes it
+    bool goal;        // a crate has to end up on this cell
+};
+
+// level files are ASCII, so every TileType indexes a table of 128 entries
+constexpr size_t TILE_TYPE_COUNT = 128;
+constexpr size_t tileIndex(TileType type) { return static_cast<unsigned char>(type) % TILE_TYPE_COUNT; }
+
+constexpr std::array<TileTraits, TILE_TYPE_COUNT> makeTileTraits() {
+    // unknown characters are walked over like floor, as the rules always did
+    std::array<TileTraits, TILE_TYPE_COUNT> traits{};
+    for (TileTraits& entry : traits) {
+        entry = {true, false, false, false};
+    }
+    traits[tileIndex(TileType::GROUNDS)] = {true, false, true, false};
+    traits[tileIndex(TileType::GROUND_OUTLINES)] = {true, false, true, true};
+    traits[tileIndex(TileType::WALLS)] = {false, false, true, false};
+    traits[tileIndex(TileType::CRATES)] = {false, true, false, false};
+    traits[tileIndex(TileType::LOCKED_CRATE)] = {false, true, false, false};
+    traits[tileIndex(TileType::HOLE_CRATES)] = {false, true, false, true};
+    traits[tileIndex(TileType::LOCKED_HOLE_CRATES)] = {false, true, false, true};
+    return traits;
+}
+
+inline constexpr std::array<TileTraits, TILE_TYPE_COUNT> TILE_TRAITS = makeTileTraits();
+
+constexpr const TileTraits& tileTraits(TileType type) { return TILE_TRAITS[tileIndex(type)]; }
+
+// returns true for every tile holding a crate, locked or not
+constexpr bool isCrate(TileType type) { return tileTraits(type).pushable; }
+
+// a cell on the board, with (0, 0) as the top-left corner
+struct Position {
+    unsigned int x;
+    unsigned int y;
+};
+
+inline bool operator==(const Position& a, const Position& b) {
+    return a.x == b.x && a.y == b.y;
+}
+inline bool operator!=(const Position& a, const Position& b) { return !(a == b); }
+
+// LURD notation: lowercase letters are moves, uppercase letters are pushes
+inline char toLurd(Direction dir, bool push) {
+    const char letters[] = {'u', 'd', 'l', 'r'};
+    char c = letters[static_cast<int>(dir)];
+    return push ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+// returns false if the letter is not part of LURD notation
+inline bool fromLurd(char c, Direction* dir) {
+    switch (c) {
+        case 'u': case 'U': *dir = Direction::Up; return true;
+        case 'd': case 'D': *dir = Direction::Down; return true;
+        case 'l': case 'L': *dir = Direction::Left; return true;
+        case 'r': case 'R': *dir = Direction::Right; return true;
+    }
+    return false;
+}
+}  // namespace SB
@@ -0,0 +1,104 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SB {
+// Optional Chrome trace-event recording, the file opens in chrome://tracing
+// or ui.perfetto.dev. Every thread appends to its own buffer; full buffers are
+// handed to a writer thread, so recording an event never touches the file.
+// While tracing is off a Scope costs one atomic load.
+class Trace {
+ public:
+    using Clock = std::chrono::steady_clock;
+
+    // times a block as one event. name and category must outlive the trace,
+    // string literals are the usual choice.
+    class Scope {
+     public:
+        explicit Scope(const char* name, const char* category = "game")
+            : _name(name), _category(category), _active(Trace::instance().enabled()) {
+            if (_active) {
+                _start = Clock::now();
+            }
+        }
+        ~Scope() {
+            if (_active) {
+                Trace::instance().complete(_name, _category, _start, Clock::now());
+            }
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+     private:
+        const char* _name;
+        const char* _category;
+        bool _active;
+        Clock::time_point _start;
+    };
+
+    static Trace& instance();
+
+    // starts recording into the file, throws std::runtime_error if it cannot be opened
+    void start(const std::string& filename);
+    // writes every buffered event and closes the file, call it before exiting
+    void stop();
+    bool enabled() const { return _enabled.load(std::memory_order_acquire); }
+
+    // records an event that ran from start to end on the calling thread
+    void complete(const char* name, const char* category,
+                  Clock::time_point start, Clock::time_point end);
+    // names the calling thread in the trace
+    void setThreadName(const std::string& name);
+
+ private:
+    struct Event {
+      const char* name;
+      const char* category;
+      int64_t start;     // microseconds since the trace started
+      int64_t duration;
+    };
+    // events of one thread, only that thread appends
+    struct Buffer {
+      std::mutex mutex;  // taken by stop() to collect what is left
+      uint32_t thread;
+      std::string threadName;
+      std::vector<Event> events;
+    };
+    struct Batch {
+      uint32_t thread;
+      std::vector<Event> events;
+    };
+
+    static const size_t BUFFER_SIZE = 4096;
+    // the calling thread's buffer, set on its first use
+    static thread_local Buffer* _current;
+
+    std::atomic<bool> _enabled{false};
+    Clock::time_point _origin;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::vector<std::unique_ptr<Buffer>> _buffers;
+    std::vector<Batch> _full;  // waiting for the writer
+    std::ofstream _out;
+    std::thread _writer;
+    bool _stopping{false};
+    bool _first{true};  // no event was written yet, so no comma is needed
+
+    Trace() = default;
+    Buffer& _buffer();
+    void _write();
+    void _writeBatch(const Batch& batch);
+};
+}  // namespace SB
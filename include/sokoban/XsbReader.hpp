@@ -0,0 +1,51 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "sokoban/Batch.hpp"
+
+namespace SB {
+// Reads the standard XSB/SOK collection format one level at a time, so a
+// collection of any size is read in a single pass with only one level in memory.
+//
+//   #  wall            $  crate            @  player
+//   .  goal            *  crate on goal    +  player on goal
+//   space, - or _  floor, run-length rows like "3#-$|#.@#" are expanded
+//
+// A "Title:" line after a board names it, otherwise the last line of text or
+// "; comment" before it does. Other lines, such as "Author:", are skipped.
+class XsbReader {
+ public:
+    // levels without a title are called name#1, name#2, ...
+    explicit XsbReader(std::istream& in, std::string name = "level");
+
+    // reads the next level, returns false once the stream has no more levels.
+    // Throws std::runtime_error for a board over 1024 rows or columns.
+    bool next(BatchLevel* level);
+
+    // returns the number of levels read so far
+    size_t count() const { return _count; }
+
+ private:
+    std::istream& _in;
+    std::string _name;
+    size_t _count{0};
+
+    std::string _line;
+    bool _hasLine{false};   // _line was read but belongs to the next level
+    std::string _pending;   // text before the next board, its name if it has no title
+    std::vector<std::string> _rows;
+    std::vector<TileType> _cells;
+
+    bool _readLine();
+    void _build(BatchLevel* level, const std::string& title);
+};
+
+// returns true for a line made of board characters only, possibly run-length encoded
+bool isXsbRow(const std::string& line);
+}  // namespace SB
@@ -0,0 +1,11 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include "sokoban/AssetCache.hpp"
+
+namespace SB {
+AssetCache& AssetCache::instance() {
+    static AssetCache cache;
+    return cache;
+}
+}  // namespace SB
@@ -0,0 +1,170 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include "sokoban/Batch.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include "sokoban/XsbReader.hpp"
+
+namespace SB {
+namespace {
+std::string escapeJson(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += ' ';
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string escapeCsv(const std::string& text) {
+    if (text.find_first_of(",\"\n") == std::string::npos) {
+        return text;
+    }
+    std::string escaped = "\"";
+    for (char c : text) {
+        escaped += c;
+        if (c == '"') {
+            escaped += '"';
+        }
+    }
+    return escaped + '"';
+}
+}  // namespace
+
+bool isXsbFile(const std::string& filename) {
+    std::string extension = std::filesystem::path(filename).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".xsb" || extension == ".sok";
+}
+
+std::vector<BatchLevel> loadLevelFile(const std::string& filename) {
+    std::ifstream ifs(filename, std::ifstream::in);
+    if (!ifs.is_open()) {
+        throw std::runtime_error("Failed to open " + filename);
+    }
+    std::string name = std::filesystem::path(filename).filename().string();
+    std::vector<BatchLevel> levels;
+    if (isXsbFile(filename)) {
+        XsbReader reader(ifs, name);
+        BatchLevel level;
+        while (reader.next(&level)) {
+            levels.push_back(std::move(level));
+        }
+        return levels;
+    }
+    // blank lines may separate the levels
+    while (ifs >> std::ws && ifs.peek() != std::ifstream::traits_type::eof()) {
+        BatchLevel level;
+        ifs >> level.board;
+        level.name = name;
+        levels.push_back(std::move(level));
+    }
+    if (levels.size() > 1) {
+        for (size_t i = 0; i < levels.size(); i++) {
+            levels[i].name = name + "#" + std::to_string(i + 1);
+        }
+    }
+    return levels;
+}
+
+std::vector<BatchLevel> loadLevels(const std::string& path) {
+    if (!std::filesystem::is_directory(path)) {
+        return loadLevelFile(path);
+    }
+    std::vector<std::string> files;
+    for (const auto& entry : std::filesystem::directory_iterator(path)) {
+        if (entry.is_regular_file() &&
+            (entry.path().extension() == ".lvl" || isXsbFile(entry.path().string()))) {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    std::vector<BatchLevel> levels;
+    for (const std::string& file : files) {
+        std::vector<BatchLevel> fileLevels;
+        try {
+            fileLevels = loadLevelFile(file);
+        } catch (const std::exception& e) {
+            BatchLevel level;
+            level.name = std::filesystem::path(file).filename().string();
+            level.error = e.what();
+            levels.push_back(std::move(level));
+            continue;
+        }
+        std::move(fileLevels.begin(), fileLevels.end(), std::back_inserter(levels));
+    }
+    return levels;
+}
+
+std::vector<BatchResult> solveBatch(const std::vector<BatchLevel>& levels,
+                                    const SolverOptions& options, ThreadPool& pool) {
+    // every task writes its own slot, so the results need no lock
+    std::vector<BatchResult> results(levels.size());
+    for (size_t i = 0; i < levels.size(); i++) {
+        pool.submit([&levels, &results, &options, i] {
+            BatchResult& result = results[i];
+            result.name = levels[i].name;
+            if (!levels[i].error.empty()) {
+                result.error = levels[i].error;
+                return;
+            }
+            auto start = std::chrono::steady_clock::now();
+            try {
+                result.solution = Solver(levels[i].board, options).solve();
+            } catch (const std::exception& e) {
+                result.error = e.what();
+            }
+            result.seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+        });
+    }
+    pool.wait();
+    return results;
+}
+
+void writeCsv(std::ostream& out, const std::vector<BatchResult>& results) {
+    out << "level,result,moves,pushes,nodes,seconds,solution\n";
+    for (const BatchResult& result : results) {
+        const Solution& solution = result.solution;
+        out << escapeCsv(result.name) << ',' <<
+               (result.error.empty() ? toString(solution.status) : "error") << ',' <<
+               solution.moveCount << ',' << solution.pushCount << ',' <<
+               solution.nodesExpanded << ',' << std::fixed << std::setprecision(6) <<
+               result.seconds << ',' << solution.moves << '\n';
+    }
+}
+
+void writeJson(std::ostream& out, const std::vector<BatchResult>& results) {
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BatchResult& result = results[i];
+        const Solution& solution = result.solution;
+        out << "  {\"level\": \"" << escapeJson(result.name) << "\", \"result\": \"" <<
+               (result.error.empty() ? toString(solution.status) : "error") << "\", " <<
+               "\"moves\": " << solution.moveCount << ", \"pushes\": " << solution.pushCount <<
+               ", \"nodes\": " << solution.nodesExpanded << ", \"seconds\": " <<
+               std::fixed << std::setprecision(6) << result.seconds <<
+               ", \"optimal\": " << (solution.optimal ? "true" : "false") <<
+               ", \"solution\": \"" << solution.moves << "\"";
+        if (!result.error.empty()) {
+            out << ", \"error\": \"" << escapeJson(result.error) << "\"";
+        }
+        out << (i + 1 < results.size() ? "},\n" : "}\n");
+    }
+    out << "]\n";
+}
+}  // namespace SB
@@ -0,0 +1,344 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include "sokoban/BitBoard.hpp"
+#include <stdexcept>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace SB {
+namespace {
+// the words are padded to an even count, so SSE2 can always take two at a time
+size_t wordCount(size_t cells) { return (cells + 127) / 128 * 2; }
+
+// returns true if every bit of b is also set in a
+bool covers(const uint64_t* a, const uint64_t* b, size_t words) {
+#ifdef __SSE2__
+    __m128i missing = _mm_setzero_si128();
+    for (size_t i = 0; i < words; i += 2) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        missing = _mm_or_si128(missing, _mm_andnot_si128(va, vb));
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) == 0xffff;
+#else
+    uint64_t missing = 0;
+    for (size_t i = 0; i < words; i++) {
+        missing |= b[i] & ~a[i];
+    }
+    return missing == 0;
+#endif
+}
+
+// returns true if a and b share a bit
+bool intersects(const uint64_t* a, const uint64_t* b, size_t words) {
+#ifdef __SSE2__
+    __m128i common = _mm_setzero_si128();
+    for (size_t i = 0; i < words; i += 2) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        common = _mm_or_si128(common, _mm_and_si128(va, vb));
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(common, _mm_setzero_si128())) != 0xffff;
+#else
+    uint64_t common = 0;
+    for (size_t i = 0; i < words; i++) {
+        common |= a[i] & b[i];
+    }
+    return common != 0;
+#endif
+}
+
+// bit i of out becomes bit i + shift of in, the cell shift cells further on
+void fromNext(const std::vector<uint64_t>& in, size_t shift, std::vector<uint64_t>* out) {
+    size_t words = in.size(), skip = shift / 64, bits = shift % 64;
+    for (size_t i = 0; i < words; i++) {
+        uint64_t low = i + skip < words ? in[i + skip] : 0;
+        uint64_t high = i + skip + 1 < words ? in[i + skip + 1] : 0;
+        (*out)[i] = bits ? (low >> bits) | (high << (64 - bits)) : low;
+    }
+}
+
+// bit i of out becomes bit i - shift of in, the cell shift cells back
+void fromPrevious(const std::vector<uint64_t>& in, size_t shift, std::vector<uint64_t>* out) {
+    size_t words = in.size(), skip = shift / 64, bits = shift % 64;
+    for (size_t i = 0; i < words; i++) {
+        uint64_t high = i >= skip ? in[i - skip] : 0;
+        uint64_t low = i >= skip + 1 ? in[i - skip - 1] : 0;
+        (*out)[i] = bits ? (high << bits) | (low >> (64 - bits)) : high;
+    }
+}
+
+// moves the position one cell, returns false if that leaves the board
+bool advance(Position* pos, Direction dir, unsigned int width, unsigned int height) {
+    switch (dir) {
+        case Direction::Up:
+            pos->y--;
+            break;
+        case Direction::Down:
+            pos->y++;
+            break;
+        case Direction::Left:
+            pos->x--;
+            break;
+        case Direction::Right:
+            pos->x++;
+            break;
+    }
+    // stepping off the top or left wraps around to a large value
+    return pos->x < width && pos->y < height;
+}
+
+Direction opposite(Direction dir) {
+    const Direction opposites[] = {Direction::Down, Direction::Up, Direction::Right, Direction::Left};
+    return opposites[static_cast<int>(dir)];
+}
+}  // namespace
+
+BitBoard::BitBoard(const Board& board) {
+    auto level = std::make_shared<Level>();
+    level->width = board.width();
+    level->height = board.height();
+    level->crateCount = board.boxCount();
+    level->goalCount = board.storageCount();
+    size_t words = wordCount(board.size());
+    for (Bits* bits : {&level->walls, &level->goals, &level->dead, &level->floor,
+                       &level->notFirst, &level->notLast, &level->squares, &level->crates}) {
+        bits->assign(words, 0);
+    }
+    for (size_t cell = 0; cell < board.size(); cell++) {
+        unsigned int x = cell % level->width, y = cell / level->width;
+        if (board[cell] == TileType::WALLS) {
+            _set(&level->walls, cell);
+        } else {
+            _set(&level->floor, cell);
+        }
+        if (board.isStorageLocation(cell)) {
+            _set(&level->goals, cell);
+        } else if (board[cell] != TileType::WALLS && board.analysis().isDeadSquare(cell)) {
+            _set(&level->dead, cell);
+        }
+        if (SB::isCrate(board[cell])) {
+            _set(&level->crates, cell);
+        }
+        if (x > 0) {
+            _set(&level->notFirst, cell);
+        }
+        if (x + 1 < level->width) {
+            _set(&level->notLast, cell);
+            if (y + 1 < level->height) {
+                _set(&level->squares, cell);
+            }
+        }
+    }
+    _hasPlayer = board.hasPlayer();
+    if (_hasPlayer) {
+        level->player = board.playerLoc();
+    }
+    for (Bits& scratch : _scratch) {
+        scratch.assign(words, 0);
+    }
+    _reach.assign(words, 0);
+    _level = std::move(level);
+    reset();
+}
+
+TileType BitBoard::operator[](size_t i) const {
+    if (isWall(i)) {
+        return TileType::WALLS;
+    }
+    if (_hasPlayer && i == playerIndex()) {
+        return TileType::PLAYER;
+    }
+    if (isCrate(i)) {
+        return isGoal(i) ? TileType::HOLE_CRATES : TileType::CRATES;
+    }
+    return isGoal(i) ? TileType::GROUND_OUTLINES : TileType::GROUNDS;
+}
+
+Position BitBoard::playerLoc() const {
+    if (!_hasPlayer) {
+        throw std::runtime_error("No player found");
+    }
+    return _playerPosition;
+}
+
+bool BitBoard::isWon() const {
+    if (!_level || _level->goalCount == 0 || _level->crateCount == 0) {
+        return true;
+    }
+    size_t words = _crates.size();
+    if (_level->crateCount >= _level->goalCount) {
+        return covers(_crates.data(), _level->goals.data(), words);
+    }
+    return covers(_level->goals.data(), _crates.data(), words);
+}
+
+bool BitBoard::isDeadlocked() const {
+    if (!_level) {
+        return false;
+    }
+    size_t words = _crates.size();
+    if (intersects(_crates.data(), _level->dead.data(), words)) {
+        return true;
+    }
+    Bits& offGoal = _scratch[0];
+    Bits& blocked = _scratch[1];
+    Bits& shifted = _scratch[2];
+    for (size_t i = 0; i < words; i++) {
+        offGoal[i] = _crates[i] & ~_level->goals[i];
+        blocked[i] = _crates[i] | _level->walls[i];
+    }
+    // a 2x2 block starts on a cell whose right, lower and lower right
+    // neighbours are all walls or crates
+    const size_t width = _level->width;
+    Bits& square = _scratch[3];
+    square = _level->squares;
+    for (size_t shift : {size_t(1), width, width + 1}) {
+        fromNext(blocked, shift, &shifted);
+        for (size_t i = 0; i < words; i++) {
+            square[i] &= blocked[i] & shifted[i];
+        }
+    }
+    // spread every block over its four cells and look for a crate off its goal
+    Bits& covered = blocked;
+    covered = square;
+    for (size_t shift : {size_t(1), width, width + 1}) {
+        fromPrevious(square, shift, &shifted);
+        for (size_t i = 0; i < words; i++) {
+            covered[i] |= shifted[i];
+        }
+    }
+    return intersects(covered.data(), offGoal.data(), words);
+}
+
+bool BitBoard::canReach(Position pos) const {
+    if (!_hasPlayer || pos.x >= width() || pos.y >= height()) {
+        return false;
+    }
+    if (!_reachValid) {
+        size_t words = _crates.size();
+        const size_t width = _level->width;
+        Bits& open = _scratch[0];
+        Bits& next = _scratch[1];
+        Bits& shifted = _scratch[2];
+        for (size_t i = 0; i < words; i++) {
+            open[i] = _level->floor[i] & ~_crates[i];
+            _reach[i] = 0;
+        }
+        _set(&_reach, playerIndex());
+        // grows the area by one step in every direction until it stops growing;
+        // a step right or left must not wrap around to the next row
+        while (true) {
+            next = _reach;
+            fromPrevious(_reach, 1, &shifted);
+            for (size_t i = 0; i < words; i++) {
+                next[i] |= shifted[i] & _level->notFirst[i];
+            }
+            fromNext(_reach, 1, &shifted);
+            for (size_t i = 0; i < words; i++) {
+                next[i] |= shifted[i] & _level->notLast[i];
+            }
+            fromPrevious(_reach, width, &shifted);
+            for (size_t i = 0; i < words; i++) {
+                next[i] |= shifted[i];
+            }
+            fromNext(_reach, width, &shifted);
+            bool grew = false;
+            for (size_t i = 0; i < words; i++) {
+                next[i] = (next[i] | shifted[i]) & open[i];
+                grew |= next[i] != _reach[i];
+            }
+            if (!grew) {
+                break;
+            }
+            std::swap(_reach, next);
+        }
+        _reachValid = true;
+    }
+    return _test(_reach, pos.y * width() + pos.x);
+}
+
+bool BitBoard::movePlayer(Direction dir) {
+    bool push;
+    if (!_step(dir, &push)) {
+        return false;
+    }
+    _moveCount++;
+    _pushCount += push;
+    // undo only moves bits, so the tiles of the step are not needed
+    _journal.record(MoveJournal::Step::make(dir, dir, push, TileType::GROUNDS, TileType::GROUNDS));
+    return true;
+}
+
+bool BitBoard::_step(Direction dir, bool* push) {
+    Position next = playerLoc();
+    if (!advance(&next, dir, width(), height())) {
+        return false;
+    }
+    size_t cell = next.y * width() + next.x;
+    if (isWall(cell)) {
+        return false;
+    }
+    *push = isCrate(cell);
+    if (*push) {
+        Position beyond = next;
+        if (!advance(&beyond, dir, width(), height())) {
+            return false;
+        }
+        size_t to = beyond.y * width() + beyond.x;
+        if (isWall(to) || isCrate(to)) {
+            return false;
+        }
+        _clear(&_crates, cell);
+        _set(&_crates, to);
+        _reachValid = false;
+    }
+    _playerPosition = next;
+    return true;
+}
+
+void BitBoard::reset() {
+    if (!_level) {
+        return;
+    }
+    _crates = _level->crates;
+    _playerPosition = _level->player;
+    _moveCount = 0;
+    _pushCount = 0;
+    _journal.clear();
+    _reachValid = false;
+}
+
+void BitBoard::undo() {
+    if (!_journal.canUndo()) {
+        return;
+    }
+    const MoveJournal::Step& step = _journal.undo();
+    // the move was legal, so every cell touched below is on the board
+    Position from = _playerPosition;
+    advance(&_playerPosition, opposite(step.direction()), width(), height());
+    if (step.isPush()) {
+        Position crate = from;
+        advance(&crate, step.direction(), width(), height());
+        _clear(&_crates, crate.y * width() + crate.x);
+        _set(&_crates, from.y * width() + from.x);
+        _reachValid = false;
+    }
+    _moveCount--;
+    _pushCount -= step.isPush();
+}
+
+void BitBoard::redo() {
+    if (!_journal.canRedo()) {
+        return;
+    }
+    bool push;
+    _step(_journal.redo().direction(), &push);
+    _moveCount++;
+    _pushCount += push;
+}
+}  // namespace SB
@@ -0,0 +1,680 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include "sokoban/Board.hpp"
+#include "sokoban/Trace.hpp"
+
+namespace SB {
+namespace {
+const Direction DIRECTIONS[] = {Direction::Up, Direction::Down, Direction::Left, Direction::Right};
+
+Direction opposite(Direction dir) {
+    const Direction opposites[] = {Direction::Down, Direction::Up, Direction::Right, Direction::Left};
+    return opposites[static_cast<int>(dir)];
+}
+}  // namespace
+
+Position Board::playerLoc() const {
+    if (!_hasPlayer) {
+        throw std::runtime_error("No player found");
+    }
+    return _playerPosition;
+}
+
+bool Board::movePlayer(Direction dir) {
+    _changed.clear();
+    MoveJournal::Step step;
+    if (!_step(dir, &step)) {
+        return false;
+    }
+    // count moves when player moves
+    _moveCount++;
+    _pushCount += step.isPush();
+    _journal.record(step);
+    _archiveMove(dir);
+    return true;
+}
+
+bool Board::_step(Direction dir, MoveJournal::Step* step) {
+    auto getNewPos = [](Direction dir, Position currentPos) -> Position {
+        switch (dir) {
+            case Direction::Up:
+                return {currentPos.x, currentPos.y - 1};
+            case Direction::Down:
+                return {currentPos.x, currentPos.y + 1};
+            case Direction::Left:
+                return {currentPos.x - 1, currentPos.y};
+            case Direction::Right:
+                return {currentPos.x + 1, currentPos.y};
+        }
+        return currentPos;
+    };
+
+    auto isNotValidMove = [&](Position pos) {
+        return pos.x >= width() || pos.y >= height();
+    };
+
+    auto vectorToIndex = [&](Position pos) {
+        return pos.y * width() + pos.x;
+    };
+
+    Position playerPos = playerLoc();
+    Position newPlayerPos = getNewPos(dir, playerPos);
+    if (isNotValidMove(newPlayerPos)) {
+        return false;
+    }
+    size_t indexPlayer = vectorToIndex(playerPos);
+    size_t indexNewPlayer = vectorToIndex(newPlayerPos);
+    TileType entered = _cells[indexNewPlayer];
+
+    // new tile contains a crate, locked crates can still be pushed where there is room
+    if (isCrate(entered)) {
+        Position newBoxPos = getNewPos(dir, newPlayerPos);
+        if (isNotValidMove(newBoxPos)) {
+            return false;
+        }
+        size_t indexNewBox = vectorToIndex(newBoxPos);
+        TileType covered = _cells[indexNewBox];
+        if (covered == TileType::WALLS || isCrate(covered)) {
+            return false;
+        }
+        // use HOLE_CRATES type when pushing crate onto a storage location
+        _cells[indexNewBox] = _goals[indexNewBox] ? TileType::HOLE_CRATES : TileType::CRATES;
+        _matchedCount += _goals[indexNewBox];
+        _matchedCount -= _goals[indexNewPlayer];
+        *step = MoveJournal::Step::make(dir, _playerDirection, true, entered, covered);
+        _changed.push_back(indexNewBox);
+    } else if (entered == TileType::WALLS) {
+        // cannot move into a wall
+        return false;
+    } else {
+        // no objects in the way
+        *step = MoveJournal::Step::make(dir, _playerDirection, false, entered, entered);
+    }
+
+    _cells[indexNewPlayer] = TileType::PLAYER;
+    // restore the storage location the player leaves, otherwise use regular floor
+    _cells[indexPlayer] = _goals[indexPlayer] ? TileType::GROUND_OUTLINES : TileType::GROUNDS;
+    _playerPosition = newPlayerPos;
+    _playerDirection = dir;
+    _changed.push_back(indexPlayer);
+    _changed.push_back(indexNewPlayer);
+    if (step->isPush()) {
+        _relock(indexNewPlayer, vectorToIndex(getNewPos(dir, newPlayerPos)));
+        _reachOrigin = NO_ORIGIN;
+    }
+    return true;
+}
+
+void Board::_unstep(const MoveJournal::Step& step) {
+    // the move was valid, so every cell touched below is on the board
+    size_t indexPlayer = playerIndex();
+    long offset = 0;
+    switch (step.direction()) {
+        case Direction::Up:
+            offset = -static_cast<long>(width());
+            _playerPosition.y++;
+            break;
+        case Direction::Down:
+            offset = width();
+            _playerPosition.y--;
+            break;
+        case Direction::Left:
+            offset = -1;
+            _playerPosition.x++;
+            break;
+        case Direction::Right:
+            offset = 1;
+            _playerPosition.x--;
+            break;
+    }
+
+    if (step.isPush()) {
+        _cells[indexPlayer + offset] = step.covered;
+        _changed.push_back(indexPlayer + offset);
+        _matchedCount -= _goals[indexPlayer + offset];
+        _matchedCount += _goals[indexPlayer];
+    }
+    _cells[indexPlayer] = step.entered;
+    _cells[indexPlayer - offset] = TileType::PLAYER;
+    _playerDirection = step.previousDirection();
+    _changed.push_back(indexPlayer);
+    _changed.push_back(indexPlayer - offset);
+    if (step.isPush()) {
+        _relock(indexPlayer + offset, indexPlayer);
+        _reachOrigin = NO_ORIGIN;
+    }
+}
+
+void Board::_relock(size_t from, size_t to) {
+    // a lock only depends on the crates touching it, and the frozen check
+    // follows at most MAX_CHAIN of them, so only the crates that few steps
+    // from the two cells can change
+    if (++_lockStamp == 0) {
+        std::fill(_lockSeen.begin(), _lockSeen.end(), 0);
+        _lockStamp = 1;
+    }
+    _lockQueue.clear();
+    auto add = [this](size_t cell) {
+        if (cell != LevelAnalysis::NO_CELL && isCrate(_cells[cell]) &&
+            _lockSeen[cell] != _lockStamp) {
+            _lockSeen[cell] = _lockStamp;
+            _lockQueue.push_back(cell);
+        }
+    };
+    add(to);
+    for (Direction dir : DIRECTIONS) {
+        add(_analysis.neighbor(from, dir));
+        add(_analysis.neighbor(to, dir));
+    }
+    size_t begin = 0;
+    for (size_t depth = 1; depth < LevelAnalysis::MAX_CHAIN && begin < _lockQueue.size(); depth++) {
+        size_t end = _lockQueue.size();
+        for (size_t i = begin; i < end; i++) {
+            for (Direction dir : DIRECTIONS) {
+                add(_analysis.neighbor(_lockQueue[i], dir));
+            }
+        }
+        begin = end;
+    }
+    for (size_t cell : _lockQueue) {
+        _updateLock(cell);
+    }
+}
+
+void Board::_updateLock(size_t cell) {
+    bool goal = _goals[cell];
+    bool locked = (!goal && _analysis.isDeadSquare(cell)) ||
+                  _analysis.isFrozen(cell, [this](size_t i) { return isCrate(_cells[i]); });
+    TileType type;
+    if (goal) {
+        type = locked ? TileType::LOCKED_HOLE_CRATES : TileType::HOLE_CRATES;
+    } else {
+        type = locked ? TileType::LOCKED_CRATE : TileType::CRATES;
+    }
+    if (_cells[cell] != type) {
+        _cells[cell] = type;
+        _changed.push_back(cell);
+    }
+}
+
+bool Board::isWon() const {
+    if (_storageCount == 0) {
+        return true;
+    }
+    if (_boxCount == 0) {
+        return true;
+    }
+    if (_boxCount >= _storageCount) {
+        return _matchedCount == _storageCount;
+    } else {
+        return _matchedCount == _boxCount;
+    }
+}
+
+void Board::reset() {
+    _changed.clear();
+    _cells = _initialBoard;
+    _playerPosition = _initialPlayerPosition;
+    _playerDirection = Direction::Down;
+    _matchedCount = _initialMatchedCount;
+    _moveCount = 0;
+    _pushCount = 0;
+    _journal.clear();
+    _reachOrigin = NO_ORIGIN;
+    if (_archive.enabled()) {
+        _archive.start(0, _snapshot());
+    }
+}
+
+void Board::undo() {
+    _changed.clear();
+    if (_moveCount <= firstMove()) {
+        return;
+    }
+    // the journal forgot this move, but the archive still has it
+    if (!_journal.canUndo()) {
+        jumpTo(_moveCount - 1);
+        return;
+    }
+    // the joined steps of a walk or push go back with the step that started it
+    while (_journal.canUndo() && _moveCount > firstMove()) {
+        const MoveJournal::Step& step = _journal.undo();
+        _unstep(step);
+        _moveCount--;
+        _pushCount -= step.isPush();
+        if (!step.isJoined()) {
+            break;
+        }
+    }
+}
+
+void Board::redo() {
+    _changed.clear();
+    if (_moveCount >= lastMove()) {
+        return;
+    }
+    if (!_journal.canRedo()) {
+        MoveJournal::Step step;
+        _step(_archive.direction(_moveCount), &step);
+        _moveCount++;
+        _pushCount += step.isPush();
+        _journal.record(step);
+        return;
+    }
+    do {
+        MoveJournal::Step step;
+        _step(_journal.redo().direction(), &step);
+        _moveCount++;
+        _pushCount += step.isPush();
+    } while (_journal.canRedo() && _journal.next().isJoined() && _moveCount < lastMove());
+}
+
+size_t Board::firstMove() const {
+    return _archive.enabled() ? _archive.first() : _moveCount - _journal.undoCount();
+}
+
+size_t Board::lastMove() const {
+    return _archive.enabled() ? _archive.size() : _moveCount + _journal.redoCount();
+}
+
+bool Board::jumpTo(size_t move) {
+    _changed.clear();
+    if (move < firstMove() || move > lastMove()) {
+        return false;
+    }
+    // the journal is cheaper over short distances, the archive bounds the rest
+    bool journal = move < _moveCount ? _moveCount - move <= _journal.undoCount()
+                                     : move - _moveCount <= _journal.redoCount();
+    size_t distance = move < _moveCount ? _moveCount - move : move - _moveCount;
+    if (journal && (!_archive.enabled() || distance <= _archive.interval())) {
+        while (_moveCount > move) {
+            const MoveJournal::Step& step = _journal.undo();
+            _unstep(step);
+            _moveCount--;
+            _pushCount -= step.isPush();
+        }
+        while (_moveCount < move) {
+            MoveJournal::Step step;
+            _step(_journal.redo().direction(), &step);
+            _moveCount++;
+            _pushCount += step.isPush();
+        }
+        return true;
+    }
+
+    size_t at;
+    const CheckpointHistory::Checkpoint& checkpoint = _archive.checkpoint(move, &at);
+    _restore(checkpoint, at);
+    _journal.clear();
+    for (; at < move; at++) {
+        MoveJournal::Step step;
+        _step(_archive.direction(at), &step);
+        _moveCount++;
+        _pushCount += step.isPush();
+        _journal.record(step);
+    }
+    // any cell may have changed since the checkpoint
+    _changed.clear();
+    for (size_t i = 0; i < _cells.size(); i++) {
+        _changed.push_back(i);
+    }
+    return true;
+}
+
+void Board::setHistoryBudget(size_t bytes) {
+    _archive = CheckpointHistory(bytes, _cells.size());
+    if (_archive.enabled()) {
+        _archive.start(_moveCount, _snapshot());
+    }
+}
+
+void Board::_archiveMove(Direction dir) {
+    if (_archive.enabled() && _archive.record(_moveCount - 1, dir)) {
+        _archive.addCheckpoint(_snapshot());
+    }
+}
+
+CheckpointHistory::Checkpoint Board::_snapshot() const {
+    CheckpointHistory::Checkpoint checkpoint;
+    checkpoint.crates.reserve(_boxCount);
+    for (size_t i = 0; i < _cells.size(); i++) {
+        if (isCrate(_cells[i])) {
+            checkpoint.crates.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    checkpoint.player = static_cast<uint32_t>(playerIndex());
+    checkpoint.direction = _playerDirection;
+    checkpoint.pushes = _pushCount;
+    return checkpoint;
+}
+
+void Board::_restore(const CheckpointHistory::Checkpoint& checkpoint, size_t move) {
+    // the level without its crates and player, then the checkpoint's on top
+    _matchedCount = 0;
+    for (size_t i = 0; i < _cells.size(); i++) {
+        TileType type = _initialBoard[i];
+        if (isCrate(type) || type == TileType::PLAYER) {
+            type = _goals[i] ? TileType::GROUND_OUTLINES : TileType::GROUNDS;
+        }
+        _cells[i] = type;
+    }
+    for (uint32_t cell : checkpoint.crates) {
+        _cells[cell] = _goals[cell] ? TileType::HOLE_CRATES : TileType::CRATES;
+        _matchedCount += _goals[cell];
+    }
+    for (uint32_t cell : checkpoint.crates) {
+        _updateLock(cell);
+    }
+    _cells[checkpoint.player] = TileType::PLAYER;
+    _playerPosition = {checkpoint.player % _width, checkpoint.player / _width};
+    _playerDirection = checkpoint.direction;
+    _pushCount = checkpoint.pushes;
+    _moveCount = static_cast<unsigned int>(move);
+    _reachOrigin = NO_ORIGIN;
+}
+
+bool Board::canReach(Position pos) const {
+    if (!_hasPlayer || pos.x >= _width || pos.y >= _height) {
+        return false;
+    }
+    // walking keeps the player inside the flooded area, only a push changes it
+    if (_reachOrigin == NO_ORIGIN) {
+        _flood(playerIndex(), LevelAnalysis::NO_CELL, LevelAnalysis::NO_CELL, &_reach);
+        _reachOrigin = playerIndex();
+    }
+    return _reach[pos.y * _width + pos.x] != UNSEEN;
+}
+
+bool Board::walkTo(Position target, std::string* moves) {
+    _changed.clear();
+    if (!canReach(target)) {
+        return false;
+    }
+    // the cached flood answers where the player may go, the path needs one from here
+    if (_reachOrigin != playerIndex()) {
+        _flood(playerIndex(), LevelAnalysis::NO_CELL, LevelAnalysis::NO_CELL, &_reach);
+        _reachOrigin = playerIndex();
+    }
+    std::vector<Direction> path;
+    _walk(_reach, _reachOrigin, target.y * _width + target.x, &path);
+    _applyPath(path, moves);
+    return true;
+}
+
+bool Board::pushTo(Position crate, Position target, std::string* moves) {
+    _changed.clear();
+    if (!_hasPlayer || crate.x >= _width || crate.y >= _height ||
+        target.x >= _width || target.y >= _height) {
+        return false;
+    }
+    size_t start = crate.y * _width + crate.x;
+    size_t goal = target.y * _width + target.x;
+    if (!isCrate(_cells[start])) {
+        return false;
+    }
+    auto open = [this, start](size_t cell) {
+        return cell != LevelAnalysis::NO_CELL &&
+               (cell == start || (_cells[cell] != TileType::WALLS && !isCrate(_cells[cell])));
+    };
+    if (goal != start && !open(goal)) {
+        return false;
+    }
+
+    // breadth first over crate cell and the side the player pushed it from,
+    // so the first time the crate lands on the goal takes the fewest pushes
+    const uint32_t NONE = UINT32_MAX;
+    const uint32_t START = UINT32_MAX - 1;
+    std::vector<uint32_t> parent(_cells.size() * 4, NONE);
+    std::vector<uint32_t> queue;
+    std::vector<uint8_t> dirs;
+    auto crateOf = [](uint32_t state) { return static_cast<size_t>(state / 4); };
+    auto dirOf = [](uint32_t state) { return static_cast<Direction>(state % 4); };
+    // the player stands where the push into the state left it
+    auto playerOf = [this, &crateOf, &dirOf](uint32_t state) {
+        return _analysis.neighbor(crateOf(state), opposite(dirOf(state)));
+    };
+    uint32_t found = goal == start ? START : NONE;
+    for (size_t i = 0; found == NONE && i <= queue.size(); i++) {
+        size_t from = i == 0 ? start : crateOf(queue[i - 1]);
+        _flood(i == 0 ? playerIndex() : playerOf(queue[i - 1]), start, from, &dirs);
+        for (Direction dir : DIRECTIONS) {
+            size_t stand = _analysis.neighbor(from, opposite(dir));
+            size_t to = _analysis.neighbor(from, dir);
+            if (stand == LevelAnalysis::NO_CELL || dirs[stand] == UNSEEN || !open(to)) {
+                continue;
+            }
+            uint32_t state = static_cast<uint32_t>(to * 4 + static_cast<int>(dir));
+            if (parent[state] == NONE) {
+                parent[state] = i == 0 ? START : queue[i - 1];
+                queue.push_back(state);
+                if (to == goal) {
+                    found = state;
+                    break;
+                }
+            }
+        }
+    }
+    if (found == NONE) {
+        return false;
+    }
+
+    std::vector<uint32_t> pushes;
+    for (uint32_t state = found; state != START; state = parent[state]) {
+        pushes.push_back(state);
+    }
+    std::reverse(pushes.begin(), pushes.end());
+    // walk to the side of the crate before each push
+    std::vector<Direction> path;
+    size_t player = playerIndex();
+    size_t from = start;
+    for (uint32_t state : pushes) {
+        _flood(player, start, from, &dirs);
+        _walk(dirs, player, _analysis.neighbor(from, opposite(dirOf(state))), &path);
+        path.push_back(dirOf(state));
+        player = from;
+        from = crateOf(state);
+    }
+    _applyPath(path, moves);
+    return true;
+}
+
+void Board::_flood(size_t start, size_t freed, size_t blocked, std::vector<uint8_t>* dirs) const {
+    auto passable = [this, freed, blocked](size_t cell) {
+        return cell != LevelAnalysis::NO_CELL && cell != blocked &&
+               (cell == freed || (_cells[cell] != TileType::WALLS && !isCrate(_cells[cell])));
+    };
+    dirs->assign(_cells.size(), UNSEEN);
+    // the start only needs to be marked seen, _walk stops there
+    (*dirs)[start] = 0;
+    _floodQueue.assign(1, start);
+    for (size_t i = 0; i < _floodQueue.size(); i++) {
+        size_t cell = _floodQueue[i];
+        for (Direction dir : DIRECTIONS) {
+            size_t next = _analysis.neighbor(cell, dir);
+            if (passable(next) && (*dirs)[next] == UNSEEN) {
+                (*dirs)[next] = static_cast<uint8_t>(dir);
+                _floodQueue.push_back(next);
+            }
+        }
+    }
+}
+
+void Board::_walk(const std::vector<uint8_t>& dirs, size_t start, size_t cell,
+                  std::vector<Direction>* path) const {
+    size_t begin = path->size();
+    for (; cell != start; cell = _analysis.neighbor(cell, opposite(static_cast<Direction>(dirs[cell])))) {
+        path->push_back(static_cast<Direction>(dirs[cell]));
+    }
+    std::reverse(path->begin() + begin, path->end());
+}
+
+void Board::_applyPath(const std::vector<Direction>& path, std::string* moves) {
+    for (size_t i = 0; i < path.size(); i++) {
+        MoveJournal::Step step;
+        if (!_step(path[i], &step)) {
+            break;
+        }
+        if (i > 0) {
+            step.flags |= MoveJournal::Step::JOINED;
+        }
+        _moveCount++;
+        _pushCount += step.isPush();
+        _journal.record(step);
+        _archiveMove(path[i]);
+        if (moves) {
+            *moves += toLurd(path[i], step.isPush());
+        }
+    }
+}
+
+Board::Board(unsigned int width, unsigned int height, const TileType* cells,
+             bool playerOnGoal) {
+    if (width == 0 || height == 0) {
+        throw std::runtime_error("Invalid dimensions");
+    }
+    _width = width;
+    _height = height;
+    _cells.assign(cells, cells + static_cast<size_t>(width) * height);
+    _load(playerOnGoal);
+}
+
+Board::Board(unsigned int width, unsigned int height, const TileType* cells,
+             const uint32_t* goals, size_t goalCount, const uint32_t* crates, size_t crateCount,
+             uint32_t player) {
+    if (width == 0 || height == 0) {
+        throw std::runtime_error("Invalid dimensions");
+    }
+    Trace::Scope scope("analyse level", "load");
+    _width = width;
+    _height = height;
+    _cells.assign(cells, cells + static_cast<size_t>(width) * height);
+    _goals.assign(_cells.size(), false);
+    for (size_t i = 0; i < goalCount; i++) {
+        if (goals[i] >= _cells.size()) {
+            throw std::runtime_error("Storage location off the board");
+        }
+        _goals[goals[i]] = true;
+    }
+    _storageCount = static_cast<unsigned int>(goalCount);
+    _boxCount = static_cast<unsigned int>(crateCount);
+    for (size_t i = 0; i < crateCount; i++) {
+        if (crates[i] >= _cells.size() || !isCrate(_cells[crates[i]])) {
+            throw std::runtime_error("No crate at a crate's cell");
+        }
+        _matchedCount += _goals[crates[i]];
+    }
+    if (player != UINT32_MAX) {
+        if (player >= _cells.size()) {
+            throw std::runtime_error("Player off the board");
+        }
+        _playerPosition = {player % width, player / width};
+        _hasPlayer = true;
+    }
+    _analyse();
+    for (size_t i = 0; i < crateCount; i++) {
+        _updateLock(crates[i]);
+    }
+    _start();
+}
+
+void Board::_load(bool playerOnGoal) {
+    Trace::Scope scope("analyse level", "load");
+    _goals.assign(_cells.size(), false);
+    _boxCount = 0;
+    _storageCount = 0;
+    _matchedCount = 0;
+    _hasPlayer = false;
+    for (size_t index = 0; index < _cells.size(); index++) {
+        TileType type = _cells[index];
+        if (type == TileType::PLAYER) {
+            _playerPosition = {static_cast<unsigned int>(index % _width),
+                               static_cast<unsigned int>(index / _width)};
+            _hasPlayer = true;
+            if (playerOnGoal) {
+                _goals[index] = true;
+                _storageCount++;
+            }
+        }
+        if (type == TileType::GROUND_OUTLINES) {
+            _goals[index] = true;
+            _storageCount++;
+        }
+        if (type == TileType::HOLE_CRATES || type == TileType::LOCKED_HOLE_CRATES) {
+            _goals[index] = true;
+            _storageCount++;
+            _matchedCount++;
+            _boxCount++;
+        }
+        if (type == TileType::CRATES || type == TileType::LOCKED_CRATE) {
+            _boxCount++;
+        }
+    }
+    _analyse();
+    for (size_t i = 0; i < _cells.size(); i++) {
+        if (isCrate(_cells[i])) {
+            _updateLock(i);
+        }
+    }
+    _start();
+}
+
+void Board::_analyse() {
+    _analysis = LevelAnalysis(_width, _height, _cells, _goals);
+    _lockSeen.assign(_cells.size(), 0);
+    _lockStamp = 0;
+}
+
+void Board::_start() {
+    _initialBoard = _cells;
+    _changed.clear();
+    _initialPlayerPosition = _playerPosition;
+    _initialMatchedCount = _matchedCount;
+    _playerDirection = Direction::Down;
+    _moveCount = 0;
+    _pushCount = 0;
+    _journal.clear();
+    _reachOrigin = NO_ORIGIN;
+    _archive = CheckpointHistory(_archive.budget(), _cells.size());
+    if (_archive.enabled()) {
+        _archive.start(0, _snapshot());
+    }
+}
+
+std::istream& operator>>(std::istream& in, Board& board) {
+    std::string line;
+    std::getline(in, line);
+    std::istringstream iss(line);
+    iss >> board._height >> board._width;
+
+    if (board.width() <= 0 || board.height() <= 0) {
+        throw std::runtime_error("Invalid dimensions");
+    }
+    board._cells.assign(board.width() * board.height(), TileType::GROUNDS);
+
+    unsigned int lineCount = 0;
+    // stop right after the last row so several levels can share one stream
+    while (lineCount < board.height() && std::getline(in, line)) {
+        for (unsigned int i = 0; i < line.size() && i < board.width(); i++) {
+            board._cells[lineCount * board.width() + i] = static_cast<TileType>(line[i]);
+        }
+        lineCount++;
+    }
+    board._load();
+    return in;
+}
+
+std::ostream& operator<<(std::ostream& out, const Board& board) {
+    out << board.height() << " " << board.width() << std::endl;
+    for (unsigned int y = 0; y < board.height(); y++) {
+        for (unsigned int x = 0; x < board.width(); x++) {
+            out << static_cast<char>(board.at(x, y));
+        }
+        out << std::endl;
+    }
+    return out;
+}
+}  // namespace SB
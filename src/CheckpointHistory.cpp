@@ -0,0 +1,82 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include "sokoban/CheckpointHistory.hpp"
+#include <utility>
+
+namespace SB {
+CheckpointHistory::CheckpointHistory(size_t budget, size_t cells) : _budget(budget) {
+    while (_interval < MAX_INTERVAL && _interval * 16 < cells) {
+        _interval *= 2;
+    }
+}
+
+void CheckpointHistory::start(size_t move, Checkpoint checkpoint) {
+    _first = _size = move;
+    _moves.clear();
+    _checkpoints.clear();
+    _checkpointBytes = _bytes(checkpoint);
+    _checkpoints.push_back(std::move(checkpoint));
+}
+
+bool CheckpointHistory::record(size_t move, Direction dir) {
+    // a new move replaces the moves that could have been redone, and the
+    // checkpoints taken on the way
+    _size = move;
+    size_t i = move - _first;
+    _moves.resize((i + 3) / 4);
+    while (_checkpoints.size() > 1 && _first + (_checkpoints.size() - 1) * _interval > move) {
+        _checkpointBytes -= _bytes(_checkpoints.back());
+        _checkpoints.pop_back();
+    }
+    if (i % 4 == 0) {
+        _moves.push_back(0);
+    }
+    uint8_t& byte = _moves[i / 4];
+    byte = static_cast<uint8_t>((byte & ~(3 << (i % 4 * 2))) | static_cast<int>(dir) << (i % 4 * 2));
+    _size++;
+    if (memoryUsage() > _budget) {
+        _trim();
+    }
+    return (_size - _first) % _interval == 0 && (_size - _first) / _interval == _checkpoints.size();
+}
+
+void CheckpointHistory::addCheckpoint(Checkpoint checkpoint) {
+    _checkpointBytes += _bytes(checkpoint);
+    _checkpoints.push_back(std::move(checkpoint));
+    if (memoryUsage() > _budget) {
+        _trim();
+    }
+}
+
+const CheckpointHistory::Checkpoint& CheckpointHistory::checkpoint(size_t move, size_t* at) const {
+    size_t i = (move - _first) / _interval;
+    if (i >= _checkpoints.size()) {
+        i = _checkpoints.size() - 1;
+    }
+    *at = _first + i * _interval;
+    return _checkpoints[i];
+}
+
+void CheckpointHistory::_trim() {
+    while (memoryUsage() > _budget && _checkpoints.size() > 1) {
+        if (_interval < MAX_INTERVAL) {
+            // keep every other checkpoint, so replays get at most twice as long
+            std::deque<Checkpoint> kept;
+            _checkpointBytes = 0;
+            for (size_t i = 0; i < _checkpoints.size(); i += 2) {
+                _checkpointBytes += _bytes(_checkpoints[i]);
+                kept.push_back(std::move(_checkpoints[i]));
+            }
+            _checkpoints.swap(kept);
+            _interval *= 2;
+            continue;
+        }
+        // the moves before the second checkpoint are only reachable through the first
+        _checkpointBytes -= _bytes(_checkpoints.front());
+        _checkpoints.pop_front();
+        _moves.erase(_moves.begin(), _moves.begin() + _interval / 4);
+        _first += _interval;
+    }
+}
+}  // namespace SB
@@ -0,0 +1,40 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include "sokoban/FrameStats.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace SB {
+void FrameStats::frame(double seconds) {
+    _frames++;
+    _total += seconds;
+    _longest = std::max(_longest, seconds);
+}
+
+std::string FrameStats::report() {
+    double wall = std::max(_elapsed(), 1e-9);
+    // clock() counts the CPU time of every thread of the process
+    double cpu = static_cast<double>(std::clock() - _cpuStart) / CLOCKS_PER_SEC;
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    out << "frames: " << _frames << " (" << _frames / wall << "/s)";
+    if (_frames > 0) {
+        out << std::setprecision(2) << " frame time: avg " << 1000 * _total / _frames <<
+               " ms, max " << 1000 * _longest << " ms";
+    }
+    out << std::setprecision(1) << " cpu: " << 100 * cpu / wall << "%";
+    _restart();
+    return out.str();
+}
+
+void FrameStats::_restart() {
+    _start = std::chrono::steady_clock::now();
+    _cpuStart = std::clock();
+    _frames = 0;
+    _total = 0;
+    _longest = 0;
+}
+}  // namespace SB
@@ -0,0 +1,303 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include "sokoban/Generator.hpp"
+#include <algorithm>
+#include <random>
+#include <utility>
+#include "sokoban/Trace.hpp"
+
+namespace SB {
+namespace {
+// The room is surrounded by walls, so stepping from any floor cell by one of
+// these offsets stays on the board.
+struct Room {
+    unsigned int width;
+    unsigned int height;
+    std::vector<uint8_t> wall;
+    std::vector<uint8_t> goal;
+    std::vector<uint8_t> crate;
+    size_t player{0};
+
+    long offset(int dir) const {
+        const long offsets[] = {-static_cast<long>(width), static_cast<long>(width), -1, 1};
+        return offsets[dir];
+    }
+    bool free(size_t cell) const { return !wall[cell] && !crate[cell]; }
+};
+
+// marks the cells the player reaches from start without moving a crate
+void reach(const Room& room, size_t start, std::vector<uint8_t>* seen, std::vector<size_t>* queue) {
+    seen->assign(room.wall.size(), 0);
+    queue->clear();
+    queue->push_back(start);
+    (*seen)[start] = 1;
+    for (size_t i = 0; i < queue->size(); i++) {
+        size_t cell = (*queue)[i];
+        for (int dir = 0; dir < 4; dir++) {
+            size_t next = cell + room.offset(dir);
+            if (!(*seen)[next] && room.free(next)) {
+                (*seen)[next] = 1;
+                queue->push_back(next);
+            }
+        }
+    }
+}
+
+// walls the border and scatters inner walls, then walls off the floor that is
+// not connected to the largest room so every floor cell can be walked to
+bool buildRoom(const GeneratorOptions& options, std::mt19937_64& random, Room* room) {
+    unsigned int width = room->width = options.width;
+    unsigned int height = room->height = options.height;
+    size_t size = static_cast<size_t>(width) * height;
+    room->wall.assign(size, 1);
+    room->goal.assign(size, 0);
+    room->crate.assign(size, 0);
+
+    std::bernoulli_distribution isWall(options.wallDensity);
+    std::vector<size_t> floor;
+    for (unsigned int y = 1; y + 1 < height; y++) {
+        for (unsigned int x = 1; x + 1 < width; x++) {
+            size_t cell = static_cast<size_t>(y) * width + x;
+            room->wall[cell] = isWall(random);
+            if (!room->wall[cell]) {
+                floor.push_back(cell);
+            }
+        }
+    }
+    if (floor.empty()) {
+        return false;
+    }
+
+    std::vector<uint8_t> seen, best;
+    std::vector<size_t> queue;
+    size_t bestSize = 0;
+    std::vector<uint8_t> visited(size, 0);
+    for (size_t cell : floor) {
+        if (visited[cell]) {
+            continue;
+        }
+        reach(*room, cell, &seen, &queue);
+        for (size_t c : queue) {
+            visited[c] = 1;
+        }
+        if (queue.size() > bestSize) {
+            bestSize = queue.size();
+            best = seen;
+        }
+    }
+    for (size_t cell : floor) {
+        room->wall[cell] = !best[cell];
+    }
+    // enough room to pull every crate off its goal
+    return bestSize >= 3 * static_cast<size_t>(options.crates) + 2;
+}
+
+// plays the solved room backwards: the player walks next to a crate and
+// pulls it one cell towards itself
+void pullCrates(const GeneratorOptions& options, std::mt19937_64& random, Room* room) {
+    struct Pull {
+        size_t crate;
+        int dir;  // the player stands next to the crate in this direction and steps further
+    };
+    std::vector<uint8_t> seen;
+    std::vector<size_t> queue;
+    std::vector<Pull> pulls;
+    std::vector<size_t> crates;
+    for (size_t cell = 0; cell < room->crate.size(); cell++) {
+        if (room->crate[cell]) {
+            crates.push_back(cell);
+        }
+    }
+
+    for (unsigned int i = 0; i < options.pulls; i++) {
+        reach(*room, room->player, &seen, &queue);
+        pulls.clear();
+        for (size_t crate : crates) {
+            for (int dir = 0; dir < 4; dir++) {
+                size_t stand = crate + room->offset(dir);
+                size_t step = stand + room->offset(dir);
+                if (seen[stand] && room->free(step)) {
+                    pulls.push_back({crate, dir});
+                }
+            }
+        }
+        if (pulls.empty()) {
+            return;
+        }
+        Pull pull = pulls[std::uniform_int_distribution<size_t>(0, pulls.size() - 1)(random)];
+        size_t stand = pull.crate + room->offset(pull.dir);
+        room->crate[pull.crate] = 0;
+        room->crate[stand] = 1;
+        room->player = stand + room->offset(pull.dir);
+        *std::find(crates.begin(), crates.end(), pull.crate) = stand;
+    }
+}
+
+// the pushes from this state that keep every crate off dead squares
+size_t countPushes(const Board& board, std::vector<uint8_t>* seen, std::vector<size_t>* queue) {
+    const LevelAnalysis& analysis = board.analysis();
+    auto passable = [&board](size_t cell) {
+        return cell != LevelAnalysis::NO_CELL && board[cell] != TileType::WALLS &&
+               !isCrate(board[cell]);
+    };
+    seen->assign(board.size(), 0);
+    queue->assign(1, board.playerIndex());
+    (*seen)[board.playerIndex()] = 1;
+    for (size_t i = 0; i < queue->size(); i++) {
+        for (Direction dir : {Direction::Up, Direction::Down, Direction::Left, Direction::Right}) {
+            size_t next = analysis.neighbor((*queue)[i], dir);
+            if (passable(next) && !(*seen)[next]) {
+                (*seen)[next] = 1;
+                queue->push_back(next);
+            }
+        }
+    }
+
+    const Direction opposite[] = {Direction::Down, Direction::Up, Direction::Right, Direction::Left};
+    size_t pushes = 0;
+    for (size_t cell = 0; cell < board.size(); cell++) {
+        if (!isCrate(board[cell])) {
+            continue;
+        }
+        for (Direction dir : {Direction::Up, Direction::Down, Direction::Left, Direction::Right}) {
+            size_t from = analysis.neighbor(cell, opposite[static_cast<int>(dir)]);
+            size_t to = analysis.neighbor(cell, dir);
+            if (from != LevelAnalysis::NO_CELL && (*seen)[from] && passable(to) &&
+                !analysis.isDeadSquare(to)) {
+                pushes++;
+            }
+        }
+    }
+    return pushes;
+}
+}  // namespace
+
+double pushBranching(const Board& board, const std::string& moves) {
+    Board replay = board;
+    std::vector<uint8_t> seen;
+    std::vector<size_t> queue;
+    size_t states = 0, choices = 0;
+    for (char c : moves) {
+        Direction dir;
+        if (!fromLurd(c, &dir)) {
+            continue;
+        }
+        if (c >= 'A' && c <= 'Z') {
+            choices += countPushes(replay, &seen, &queue);
+            states++;
+        }
+        replay.movePlayer(dir);
+    }
+    return states ? static_cast<double>(choices) / states : 0;
+}
+
+bool generateLevel(const GeneratorOptions& options, uint64_t candidate, GeneratedLevel* level) {
+    Trace::Scope scope("generate level", "generator");
+    if (options.width < 3 || options.height < 3 || options.crates == 0) {
+        return false;
+    }
+    std::seed_seq seed{static_cast<uint32_t>(options.seed), static_cast<uint32_t>(options.seed >> 32),
+                       static_cast<uint32_t>(candidate), static_cast<uint32_t>(candidate >> 32)};
+    std::mt19937_64 random(seed);
+
+    Room room;
+    if (!buildRoom(options, random, &room)) {
+        return false;
+    }
+    // the solved state: every crate on its goal and the player somewhere else
+    std::vector<size_t> floor;
+    for (size_t cell = 0; cell < room.wall.size(); cell++) {
+        if (!room.wall[cell]) {
+            floor.push_back(cell);
+        }
+    }
+    std::shuffle(floor.begin(), floor.end(), random);
+    for (unsigned int i = 0; i < options.crates; i++) {
+        room.goal[floor[i]] = room.crate[floor[i]] = 1;
+    }
+    room.player = floor[options.crates];
+    pullCrates(options, random, &room);
+
+    // the level format cannot put the player on a goal, so it walks off it
+    if (room.goal[room.player]) {
+        std::vector<uint8_t> seen;
+        std::vector<size_t> queue;
+        reach(room, room.player, &seen, &queue);
+        auto off = std::find_if(queue.begin(), queue.end(),
+                                [&room](size_t cell) { return !room.goal[cell]; });
+        if (off == queue.end()) {
+            return false;
+        }
+        room.player = *off;
+    }
+
+    std::vector<TileType> cells(room.wall.size(), TileType::GROUNDS);
+    for (size_t cell = 0; cell < cells.size(); cell++) {
+        if (room.wall[cell]) {
+            cells[cell] = TileType::WALLS;
+        } else if (room.crate[cell]) {
+            cells[cell] = room.goal[cell] ? TileType::HOLE_CRATES : TileType::CRATES;
+        } else if (room.goal[cell]) {
+            cells[cell] = TileType::GROUND_OUTLINES;
+        }
+    }
+    cells[room.player] = TileType::PLAYER;
+    Board board(room.width, room.height, cells.data());
+    if (board.isWon()) {
+        return false;
+    }
+
+    SolverOptions solverOptions;
+    solverOptions.maxNodes = options.maxNodes;
+    // a small table is enough for the searches that are not cut off
+    solverOptions.tableSize = std::min<size_t>(size_t(1) << 20,
+                                               std::max<size_t>(4096, 2 * options.maxNodes));
+    Solution solution = Solver(board, solverOptions).solve();
+    if (!solution.solved() || solution.pushCount < options.minPushes ||
+        solution.pushCount > options.maxPushes || solution.moveCount < options.minMoves) {
+        return false;
+    }
+    double branching = pushBranching(board, solution.moves);
+    if (branching < options.minBranching) {
+        return false;
+    }
+
+    level->board = std::move(board);
+    level->solution = std::move(solution);
+    level->branching = branching;
+    level->candidate = candidate;
+    return true;
+}
+
+std::vector<GeneratedLevel> generateLevels(const GeneratorOptions& options, size_t count,
+                                           ThreadPool& pool, size_t* candidates) {
+    std::vector<GeneratedLevel> kept;
+    uint64_t next = 0;
+    // several candidates per thread and round keep the pool busy between rounds
+    size_t round = std::max<size_t>(1, pool.size()) * 8;
+    while (kept.size() < count && (options.maxCandidates == 0 || next < options.maxCandidates)) {
+        size_t batch = options.maxCandidates == 0 ? round :
+                       std::min<size_t>(round, options.maxCandidates - next);
+        std::vector<GeneratedLevel> levels(batch);
+        std::vector<uint8_t> accepted(batch, 0);
+        for (size_t i = 0; i < batch; i++) {
+            pool.submit([&options, &levels, &accepted, next, i] {
+                accepted[i] = generateLevel(options, next + i, &levels[i]);
+            });
+        }
+        pool.wait();
+        // keeping the first accepted candidates makes the result independent of the thread count
+        for (size_t i = 0; i < batch && kept.size() < count; i++) {
+            if (accepted[i]) {
+                kept.push_back(std::move(levels[i]));
+            }
+        }
+        next += batch;
+    }
+    if (candidates) {
+        *candidates = next;
+    }
+    return kept;
+}
+}  // namespace SB
@@ -0,0 +1,62 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include "sokoban/LevelAnalysis.hpp"
+
+namespace SB {
+LevelAnalysis::LevelAnalysis(unsigned int width, unsigned int height,
+                             const std::vector<TileType>& cells,
+                             const std::vector<bool>& goals)
+    : _width(width), _height(height) {
+    _walls.resize(cells.size());
+    for (size_t i = 0; i < cells.size(); i++) {
+        _walls[i] = cells[i] == TileType::WALLS;
+    }
+    _computePushDistance(goals);
+}
+
+size_t LevelAnalysis::neighbor(size_t cell, Direction dir) const {
+    size_t x = cell % _width;
+    size_t y = cell / _width;
+    switch (dir) {
+        case Direction::Up:
+            return y > 0 ? cell - _width : NO_CELL;
+        case Direction::Down:
+            return y + 1 < _height ? cell + _width : NO_CELL;
+        case Direction::Left:
+            return x > 0 ? cell - 1 : NO_CELL;
+        case Direction::Right:
+            return x + 1 < _width ? cell + 1 : NO_CELL;
+    }
+    return NO_CELL;
+}
+
+void LevelAnalysis::_computePushDistance(const std::vector<bool>& goals) {
+    // pull crates backwards from every goal: a crate on `from` can be pushed to
+    // `to` if the player fits behind it on the far side of `from`
+    _pushDistance.assign(_walls.size(), UNREACHABLE);
+    std::vector<size_t> queue;
+    queue.reserve(_walls.size());
+    for (size_t cell = 0; cell < _walls.size(); cell++) {
+        if (goals[cell] && !_walls[cell]) {
+            _pushDistance[cell] = 0;
+            queue.push_back(cell);
+        }
+    }
+    const Direction directions[] = {Direction::Up, Direction::Down,
+                                    Direction::Left, Direction::Right};
+    for (size_t head = 0; head < queue.size(); head++) {
+        size_t to = queue[head];
+        for (Direction dir : directions) {
+            size_t from = neighbor(to, dir);
+            size_t behind = from == NO_CELL ? NO_CELL : neighbor(from, dir);
+            if (behind == NO_CELL || _walls[from] || _walls[behind] ||
+                _pushDistance[from] != UNREACHABLE) {
+                continue;
+            }
+            _pushDistance[from] = _pushDistance[to] + 1;
+            queue.push_back(from);
+        }
+    }
+}
+}  // namespace SB
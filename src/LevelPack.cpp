@@ -0,0 +1,210 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include "sokoban/LevelPack.hpp"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SOKOBAN_HAS_MMAP 1
+#endif
+
+namespace SB {
+namespace {
+const char MAGIC[4] = {'S', 'B', 'P', 'K'};
+// written in the byte order of the machine, a pack from the other byte order is refused
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t count;
+};
+
+struct IndexEntry {
+    uint64_t offset;  // of the level's record from the start of the file
+    uint32_t nameLength;
+    uint32_t width;
+    uint32_t height;
+    uint32_t goalCount;
+    uint32_t crateCount;
+    uint32_t player;
+};
+
+// a record is the name, the tiles, the goals and the crates, each padded to 4 bytes
+size_t padded(size_t size) { return (size + 3) & ~size_t(3); }
+
+size_t recordSize(const IndexEntry& entry) {
+    return padded(entry.nameLength) +
+           padded(static_cast<size_t>(entry.width) * entry.height) +
+           4 * (static_cast<size_t>(entry.goalCount) + entry.crateCount);
+}
+}  // namespace
+
+LevelPack::LevelPack(const std::string& filename) {
+#ifdef SOKOBAN_HAS_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open " + filename);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to open " + filename);
+    }
+    _size = static_cast<size_t>(info.st_size);
+    if (_size > 0) {
+        void* data = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Failed to map " + filename);
+        }
+        _data = static_cast<const unsigned char*>(data);
+        _mapped = true;
+    }
+    ::close(fd);
+#else
+    std::ifstream ifs(filename, std::ios::binary);
+    if (!ifs.is_open()) {
+        throw std::runtime_error("Failed to open " + filename);
+    }
+    std::vector<char> bytes((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    _size = bytes.size();
+    unsigned char* data = new unsigned char[_size];
+    std::memcpy(data, bytes.data(), _size);
+    _data = data;
+#endif
+
+    Header header;
+    if (_size < sizeof(header)) {
+        _close();
+        throw std::runtime_error(filename + " is not a level pack");
+    }
+    std::memcpy(&header, _data, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != VERSION || header.byteOrder != BYTE_ORDER_MARK ||
+        (_size - sizeof(header)) / sizeof(IndexEntry) < header.count) {
+        _close();
+        throw std::runtime_error(filename + " is not a level pack");
+    }
+    _count = header.count;
+}
+
+LevelPack::~LevelPack() { _close(); }
+
+void LevelPack::_close() {
+#ifdef SOKOBAN_HAS_MMAP
+    if (_mapped) {
+        ::munmap(const_cast<unsigned char*>(_data), _size);
+    }
+#else
+    delete[] _data;
+#endif
+    _data = nullptr;
+    _mapped = false;
+}
+
+PackedLevel LevelPack::level(size_t i) const {
+    if (i >= _count) {
+        throw std::out_of_range("No level " + std::to_string(i) + " in the pack");
+    }
+    IndexEntry entry;
+    std::memcpy(&entry, _data + sizeof(Header) + i * sizeof(IndexEntry), sizeof(entry));
+    if (entry.offset > _size || recordSize(entry) > _size - entry.offset) {
+        throw std::runtime_error("Damaged level pack");
+    }
+
+    const unsigned char* record = _data + entry.offset;
+    PackedLevel level;
+    level.name = std::string_view(reinterpret_cast<const char*>(record), entry.nameLength);
+    record += padded(entry.nameLength);
+    level.width = entry.width;
+    level.height = entry.height;
+    level.cells = reinterpret_cast<const TileType*>(record);
+    record += padded(static_cast<size_t>(entry.width) * entry.height);
+    level.goals = reinterpret_cast<const uint32_t*>(record);
+    level.goalCount = entry.goalCount;
+    record += 4 * static_cast<size_t>(entry.goalCount);
+    level.crates = reinterpret_cast<const uint32_t*>(record);
+    level.crateCount = entry.crateCount;
+    level.player = entry.player;
+    return level;
+}
+
+Board LevelPack::board(size_t i) const {
+    // the goal and crate lists spare the board its scan of the tiles
+    PackedLevel packed = level(i);
+    try {
+        return Board(packed.width, packed.height, packed.cells, packed.goals,
+                     packed.goalCount, packed.crates, packed.crateCount, packed.player);
+    } catch (const std::runtime_error&) {
+        throw std::runtime_error("Damaged level pack");
+    }
+}
+
+void LevelPack::write(const std::string& filename, const std::vector<BatchLevel>& levels) {
+    std::vector<IndexEntry> index(levels.size());
+    std::vector<unsigned char> records;
+    uint64_t base = sizeof(Header) + levels.size() * sizeof(IndexEntry);
+
+    auto append = [&records](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        records.insert(records.end(), bytes, bytes + size);
+        records.resize(padded(records.size()), 0);
+    };
+    for (size_t i = 0; i < levels.size(); i++) {
+        const Board& board = levels[i].board;
+        std::vector<TileType> cells(board.size());
+        std::vector<uint32_t> goals, crates;
+        uint32_t player = PackedLevel::NO_PLAYER;
+        for (size_t cell = 0; cell < board.size(); cell++) {
+            cells[cell] = board[cell];
+            if (board.isStorageLocation(cell)) {
+                goals.push_back(static_cast<uint32_t>(cell));
+            }
+            if (isCrate(board[cell])) {
+                crates.push_back(static_cast<uint32_t>(cell));
+            }
+            if (board[cell] == TileType::PLAYER) {
+                player = static_cast<uint32_t>(cell);
+            }
+        }
+
+        IndexEntry& entry = index[i];
+        entry.offset = base + records.size();
+        entry.nameLength = static_cast<uint32_t>(levels[i].name.size());
+        entry.width = board.width();
+        entry.height = board.height();
+        entry.goalCount = static_cast<uint32_t>(goals.size());
+        entry.crateCount = static_cast<uint32_t>(crates.size());
+        entry.player = player;
+        append(levels[i].name.data(), levels[i].name.size());
+        append(cells.data(), cells.size());
+        append(goals.data(), 4 * goals.size());
+        append(crates.data(), 4 * crates.size());
+    }
+
+    std::ofstream ofs(filename, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) {
+        throw std::runtime_error("Failed to open " + filename);
+    }
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.count = static_cast<uint32_t>(levels.size());
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(IndexEntry));
+    ofs.write(reinterpret_cast<const char*>(records.data()), records.size());
+    if (!ofs) {
+        throw std::runtime_error("Failed to write " + filename);
+    }
+}
+}  // namespace SB
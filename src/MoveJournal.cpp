@@ -0,0 +1,58 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include "sokoban/MoveJournal.hpp"
+
+namespace SB {
+void MoveJournal::record(const Step& step) {
+    // a new move makes the undone moves unreachable
+    _size = _cursor;
+    if (_size == _limit) {
+        _head = _head + 1 == _limit ? 0 : _head + 1;
+        _size--;
+        _cursor--;
+    }
+    size_t i = _head + _size;
+    if (i >= _limit) {
+        i -= _limit;
+    }
+    // the buffer only grows until it wraps around for the first time, into
+    // room for the whole ring reserved by the first move. Only the pages
+    // written so far cost memory, and recording never reallocates.
+    if (i == _entries.size()) {
+        if (_entries.capacity() < _limit) {
+            _entries.reserve(_limit);
+        }
+        _entries.push_back(step);
+    } else {
+        _entries[i] = step;
+    }
+    _size++;
+    _cursor++;
+}
+
+const MoveJournal::Step& MoveJournal::undo() {
+    _cursor--;
+    return _at(_cursor);
+}
+
+const MoveJournal::Step& MoveJournal::redo() {
+    _cursor++;
+    return _at(_cursor - 1);
+}
+
+void MoveJournal::setLimit(size_t limit) {
+    // keep the most recent applied moves, in order, in a fresh buffer
+    limit = limit ? limit : 1;
+    size_t keep = _cursor < limit ? _cursor : limit;
+    std::vector<Step> entries;
+    entries.reserve(keep);
+    for (size_t i = _cursor - keep; i < _cursor; i++) {
+        entries.push_back(_at(i));
+    }
+    _entries.swap(entries);
+    _limit = limit;
+    _head = 0;
+    _size = _cursor = keep;
+}
+}  // namespace SB
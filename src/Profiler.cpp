@@ -0,0 +1,89 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include "sokoban/Profiler.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace SB {
+namespace {
+// upper bound of a bucket in seconds
+double bucketLimit(size_t bucket) {
+    return static_cast<double>(1ull << bucket) * 1e-6;
+}
+}  // namespace
+
+double Profiler::Phase::percentile(double p) const {
+    if (count == 0) {
+        return 0;
+    }
+    size_t target = static_cast<size_t>(p * count);
+    size_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += buckets[bucket];
+        if (seen > target) {
+            return std::min(bucketLimit(bucket), longest);
+        }
+    }
+    return longest;
+}
+
+size_t Profiler::add(const std::string& name) {
+    Phase phase;
+    phase.name = name;
+    _phases.push_back(phase);
+    return _phases.size() - 1;
+}
+
+void Profiler::record(size_t id, double seconds) {
+    Phase& phase = _phases[id];
+    phase.count++;
+    phase.total += seconds;
+    phase.longest = std::max(phase.longest, seconds);
+    size_t bucket = 0;
+    for (double limit = 1e-6; seconds >= limit && bucket + 1 < BUCKETS; limit *= 2) {
+        bucket++;
+    }
+    phase.buckets[bucket]++;
+}
+
+std::string Profiler::overlay() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    for (const Phase& phase : _phases) {
+        out << std::left << std::setw(8) << phase.name << std::right <<
+               " avg " << 1000 * phase.average() <<
+               " p99 " << 1000 * phase.percentile(0.99) <<
+               " max " << 1000 * phase.longest << " ms\n";
+    }
+    return out.str();
+}
+
+void Profiler::write(std::ostream& out) const {
+    out << "phase,samples,avg_ms,p50_ms,p99_ms,max_ms\n";
+    out << std::fixed << std::setprecision(4);
+    for (const Phase& phase : _phases) {
+        out << phase.name << ',' << phase.count << ',' << 1000 * phase.average() << ',' <<
+               1000 * phase.percentile(0.5) << ',' << 1000 * phase.percentile(0.99) << ',' <<
+               1000 * phase.longest << '\n';
+    }
+    // the histograms follow, one line per non-empty bucket
+    out << "\nphase,below_us,samples\n";
+    for (const Phase& phase : _phases) {
+        for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+            if (phase.buckets[bucket] > 0) {
+                out << phase.name << ',' << (1ull << bucket) << ',' << phase.buckets[bucket] << '\n';
+            }
+        }
+    }
+}
+
+void Profiler::clear() {
+    for (Phase& phase : _phases) {
+        std::string name = phase.name;
+        phase = Phase();
+        phase.name = name;
+    }
+}
+}  // namespace SB
@@ -0,0 +1,78 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include "sokoban/Replay.hpp"
+#include "sokoban/BitBoard.hpp"
+#include "sokoban/FixedBoard.hpp"
+
+namespace SB {
+void MoveRecorder::restart() {
+    _start = std::chrono::steady_clock::now();
+    _moves.clear();
+    _times.clear();
+    // room for a long attempt up front, so recording a move does not
+    // allocate; the pages are only touched as moves are recorded
+    _moves.reserve(RESERVED_MOVES);
+    _times.reserve(RESERVED_MOVES);
+    _cursor = 0;
+}
+
+void MoveRecorder::record(Direction dir, bool push) {
+    // a new move replaces the moves that could have been redone
+    _moves.resize(_cursor);
+    _times.resize(_cursor);
+    _moves += toLurd(dir, push);
+    _times.push_back(static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - _start).count()));
+    _cursor++;
+}
+
+std::vector<unsigned long> MoveRecorder::times() const {
+    return std::vector<unsigned long>(_times.begin(), _times.begin() + _cursor);
+}
+
+std::ostream& operator<<(std::ostream& out, const MoveRecorder& recorder) {
+    out << recorder.moves() << '\t';
+    for (size_t i = 0; i < recorder._cursor; i++) {
+        out << (i > 0 ? "," : "") << recorder._times[i];
+    }
+    return out;
+}
+
+template <typename B>
+ReplayResult replay(B* board, std::string_view moves) {
+    ReplayResult result;
+    for (char c : moves) {
+        if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+            continue;
+        }
+        Direction dir;
+        if (!fromLurd(c, &dir)) {
+            result.valid = false;
+            break;
+        }
+        unsigned int pushes = board->getPushCount();
+        if (!board->movePlayer(dir)) {
+            result.valid = false;
+            break;
+        }
+        // uppercase letters are exactly the pushes
+        bool pushed = board->getPushCount() != pushes;
+        result.applied++;
+        if (pushed != (c >= 'A' && c <= 'Z')) {
+            result.valid = false;
+            break;
+        }
+    }
+    result.moves = board->getMoveCount();
+    result.pushes = board->getPushCount();
+    result.won = board->isWon();
+    return result;
+}
+
+template ReplayResult replay(Board* board, std::string_view moves);
+template ReplayResult replay(BitBoard* board, std::string_view moves);
+template ReplayResult replay(FixedBoard<16, 16>* board, std::string_view moves);
+template ReplayResult replay(FixedBoard<32, 32>* board, std::string_view moves);
+}  // namespace SB
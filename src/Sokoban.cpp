@@ -2,29 +2,28 @@
 // By Nguyen Mai
 
 #include <fstream>  // for ifs
+#include <utility>  // for std::move
 #include "sokoban/Sokoban.hpp"
 
 namespace SB {
-std::vector<sf::Vector2u> Sokoban::_storagePositions;
-
 Sokoban::Sokoban() : _tileClassifier(),
 _frameIndex(std::make_shared<unsigned int>(0)),
 _seed(std::make_shared<unsigned int>(0)),
-_height(0), _width(0),
-_floor(_tileClassifier.createTile('.'))
-{}
+_floor(_tileClassifier.createTile('.')) {
+    _loadTiles();
+}
 Sokoban::Sokoban(std::shared_ptr<unsigned int> seed) : _tileClassifier(),
 _frameIndex(std::make_shared<unsigned int>(0)),
 _seed(seed),
-_height(0), _width(0),
-_floor(_tileClassifier.createTile('.', seed))
-{}
+_floor(_tileClassifier.createTile('.', seed)) {
+    _loadTiles();
+}
 
 Sokoban::Sokoban(const std::string& filename) : _tileClassifier(),
 _frameIndex(std::make_shared<unsigned int>(0)),
 _seed(std::make_shared<unsigned int>(0)),
-_height(0), _width(0),
 _floor(_tileClassifier.createTile('.')) {
+    _loadTiles();
     std::ifstream ifs(filename, std::ifstream::in);
     if (!ifs.is_open()) {
         throw std::runtime_error("Failed to open " + filename);
@@ -32,294 +31,279 @@ _floor(_tileClassifier.createTile('.')) {
     ifs >> *this;
 }
 
-void Sokoban::draw(sf::RenderTarget& target, sf::RenderStates states) const {
-    auto drawTile = [&](size_t x, size_t y, const Tile& tile) {
-        sf::Sprite qTile = tile.sprite;
-        // find the image size and scale it to match given TILE_SIZE
-        // ideally, the images should be the size of TILE_SIZE
-        qTile.scale(TILE_SIZE / qTile.getLocalBounds().height,
-                    TILE_SIZE / qTile.getLocalBounds().width);
-        qTile.setPosition(x * TILE_SIZE, y * TILE_SIZE);
-        // if (tile.type == TileType::WIN) {
-        //     qTile.setColor(sf::Color::Green);
-        // }
-        return qTile;
-    };
-
-    auto isStorageLocation = [&](unsigned int x, unsigned int y) {
-        sf::Vector2u pos(x, y);
-        for (const auto& storagePos : _storagePositions) {
-            if (storagePos == pos) {
-                return true;
-            }
-        }
-        return false;
+void Sokoban::_loadTiles() {
+    const TileType types[] = {
+        TileType::GROUNDS, TileType::WALLS, TileType::CRATES, TileType::HOLE,
+        TileType::COINS, TileType::LOCKED_CRATE, TileType::GROUND_OUTLINES,
+        TileType::OUTLINES, TileType::DIM_CRATES, TileType::DIM_HOLE_CRATES,
+        TileType::FALLING_CRATES, TileType::HOLE_CRATES, TileType::LOCKED_HOLE_CRATES
     };
-
-    // row-major order
-    for (unsigned int y = 0; y < height(); y++) {
-        for (unsigned int x = 0; x < width(); x++) {
-            unsigned int i = y * width() + x;
-            // check if a background tile is already drawn
-            // if none, then draw one
-            bool isNotBackground = _gameBoard[i].type != TileType::GROUNDS &&
-                                _gameBoard[i].type != TileType::HOLE &&
-                                _gameBoard[i].type != TileType::GROUND_OUTLINES;
-            // if player is on storage location, draw outline instead of floor
-            if (_gameBoard[i].type == TileType::PLAYER && isStorageLocation(x, y)) {
-                target.draw(drawTile(x, y, _outline), states);
-            } else if (isNotBackground) {
-                target.draw(drawTile(x, y, _floor), states);
-            }
-            target.draw(drawTile(x, y, _gameBoard[i]), states);
-        }
+    for (TileType type : types) {
+        _tiles[tileIndex(type)] = _tileClassifier.createTile(static_cast<char>(type), _seed);
     }
+    _player = _tileClassifier.createTile(static_cast<char>(TileType::PLAYER));
 }
 
-sf::Vector2u Sokoban::playerLoc() const {
-    sf::Vector2u playerLocation;
-    bool playerLocated = false;
-    for (size_t i = 0; i < _gameBoard.size(); i++) {
-        if (_gameBoard[i].type == TileType::PLAYER) {
-            playerLocation = {
-                // row-major order
-                static_cast<unsigned int>(i % width()),
-                static_cast<unsigned int>(i / width())
-            };
-            playerLocated = true;
-        }
-    }
-    if (!playerLocated) {
-        throw std::runtime_error("No player found");
-    }
-
-    return playerLocation;
+void Sokoban::_syncPlayer() {
+    // the board restores the direction the player faced, redraw it facing that way
+    _player = _tileClassifier.getAnimation(_board.playerDirection(),
+                                           _board.playerDirection(), _frameIndex);
 }
 
-void Sokoban::movePlayer(Direction dir) {
-    auto getNewPos = [](Direction dir, sf::Vector2u currentPos) -> sf::Vector2u {
-        switch (dir) {
-            case Direction::Up:
-                return {currentPos.x, currentPos.y - 1};
-            case Direction::Down:
-                return {currentPos.x, currentPos.y + 1};
-            case Direction::Left:
-                return {currentPos.x - 1, currentPos.y};
-            case Direction::Right:
-                return {currentPos.x + 1, currentPos.y};
-        }
-        return currentPos;
-    };
-
-    auto isOnTopOfStorageLocation = [&](sf::Vector2u pos) {
-        for (auto it = _storagePositions.begin(); it != _storagePositions.end(); it++) {
-            if (*it == pos) {
-                return true;
-            }
-        }
-        return false;
-    };
+namespace {
+// appends two triangles covering the cell, textured with the given rectangle
+void addQuad(sf::VertexArray* vertices, unsigned int x, unsigned int y, const sf::IntRect& rect) {
+    float left = static_cast<float>(x * Sokoban::TILE_SIZE);
+    float top = static_cast<float>(y * Sokoban::TILE_SIZE);
+    float right = left + Sokoban::TILE_SIZE;
+    float bottom = top + Sokoban::TILE_SIZE;
+    float u0 = static_cast<float>(rect.left);
+    float v0 = static_cast<float>(rect.top);
+    float u1 = u0 + rect.width;
+    float v1 = v0 + rect.height;
+    vertices->append(sf::Vertex(sf::Vector2f(left, top), sf::Vector2f(u0, v0)));
+    vertices->append(sf::Vertex(sf::Vector2f(right, top), sf::Vector2f(u1, v0)));
+    vertices->append(sf::Vertex(sf::Vector2f(right, bottom), sf::Vector2f(u1, v1)));
+    vertices->append(sf::Vertex(sf::Vector2f(left, top), sf::Vector2f(u0, v0)));
+    vertices->append(sf::Vertex(sf::Vector2f(right, bottom), sf::Vector2f(u1, v1)));
+    vertices->append(sf::Vertex(sf::Vector2f(left, bottom), sf::Vector2f(u0, v1)));
+}
+}  // namespace
 
-    auto isNotValidMove = [&](sf::Vector2u pos) {
-        return pos.x >= width() || pos.y >= height();
+void Sokoban::_addStaticTiles(sf::VertexArray* vertices, unsigned int x, unsigned int y) const {
+    unsigned int variant = _variants[y * width() + x];
+    auto add = [&](TileType type) {
+        addQuad(vertices, x, y, _tileClassifier.region(_tileClassifier.frame(type, variant)));
     };
+    if (_board.at(x, y) == TileType::WALLS) {
+        add(TileType::GROUNDS);
+        add(TileType::WALLS);
+    } else if (_board.isStorageLocation({x, y})) {
+        add(TileType::GROUND_OUTLINES);
+    } else {
+        add(TileType::GROUNDS);
+    }
+}
 
-    auto vectorToIndex = [&](sf::Vector2u pos) {
-        return pos.y * width() + pos.x;
-    };
+void Sokoban::_addDynamicTile(sf::VertexArray* vertices, unsigned int x, unsigned int y) const {
+    TileType type = _board.at(x, y);
+    if (tileTraits(type).background) {
+        return;  // already part of the static layer
+    }
+    const Tile& tile = type == TileType::PLAYER ? _player : _tiles[tileIndex(type)];
+    addQuad(vertices, x, y, _tileClassifier.region(tile.frame));
+}
 
-    sf::Vector2u playerPos = playerLoc();
-    sf::Vector2u newPlayerPos = getNewPos(dir, playerPos);
-    if (isNotValidMove(newPlayerPos)) {
+void Sokoban::_renderLayers() {
+    unsigned int w = pixelWidth(), h = pixelHeight();
+    _hasLayers = w > 0 && h > 0 && w <= sf::Texture::getMaximumSize() &&
+                 h <= sf::Texture::getMaximumSize() &&
+                 _staticLayer.create(w, h) && _boardLayer.create(w, h);
+    if (!_hasLayers) {
         return;
     }
-    size_t indexPlayer = vectorToIndex(playerPos);
-    size_t indexNewPlayer = vectorToIndex(newPlayerPos);
+    sf::RenderStates atlas(&_tileClassifier.texture());
 
-    // if player moves, then moveMade is true
-    // otherwise, if player runs into a wall, then
-    // moveMade is false
-    bool moveMade = false;
+    _vertices.clear();
+    for (unsigned int y = 0; y < height(); y++) {
+        for (unsigned int x = 0; x < width(); x++) {
+            _addStaticTiles(&_vertices, x, y);
+        }
+    }
+    _staticLayer.clear(sf::Color::Transparent);
+    _staticLayer.draw(_vertices, atlas);
+    _staticLayer.display();
+    _renderBoard();
+}
 
-    // new tile contains a crate
-    if (_gameBoard[indexNewPlayer].type == TileType::CRATES ||
-        _gameBoard[indexNewPlayer].type == TileType::HOLE_CRATES) {
-        sf::Vector2u newBoxPos = getNewPos(dir, newPlayerPos);
-        if (isNotValidMove(newBoxPos)) {
-            return;
+void Sokoban::_renderBoard() {
+    if (!_hasLayers) {
+        return;
+    }
+    _vertices.clear();
+    for (unsigned int y = 0; y < height(); y++) {
+        for (unsigned int x = 0; x < width(); x++) {
+            _addDynamicTile(&_vertices, x, y);
         }
-        size_t indexNewBox = vectorToIndex(newBoxPos);
-        if (_gameBoard[indexNewBox].type != TileType::WALLS &&
-            _gameBoard[indexNewBox].type != TileType::LOCKED_CRATE &&
-            _gameBoard[indexNewBox].type != TileType::CRATES &&
-            _gameBoard[indexNewBox].type != TileType::HOLE_CRATES) {
-            // if crate on storage location
-            if (isOnTopOfStorageLocation(newBoxPos)) {
-                // use HOLE_CRATES type when pushing crate onto a storage location
-                _gameBoard[indexNewBox] =
-                    _tileClassifier.createTile(static_cast<char>(TileType::HOLE_CRATES), _seed);
-            } else {
-                // regular crate on regular floor
-                _gameBoard[indexNewBox] =
-                    _tileClassifier.createTile(static_cast<char>(TileType::CRATES), _seed);
-            }
+    }
+    _boardLayer.clear(sf::Color::Transparent);
+    _boardLayer.draw(sf::Sprite(_staticLayer.getTexture()));
+    _boardLayer.draw(_vertices, sf::RenderStates(&_tileClassifier.texture()));
+    _boardLayer.display();
+}
 
-            _gameBoard[indexNewPlayer] = TileClassifier::getAnimation(dir, _frameIndex);
+void Sokoban::_renderCells(const std::vector<size_t>& cells) {
+    if (!_hasLayers) {
+        return;
+    }
+    // copy the static pixels over each changed cell, then draw what is on it now
+    _background.clear();
+    _vertices.clear();
+    auto addCell = [&](size_t cell) {
+        unsigned int x = cell % width(), y = cell / width();
+        addQuad(&_background, x, y, sf::IntRect(x * TILE_SIZE, y * TILE_SIZE, TILE_SIZE, TILE_SIZE));
+        _addDynamicTile(&_vertices, x, y);
+    };
+    for (size_t cell : cells) {
+        addCell(cell);
+    }
+    // the player's animation frame can change without the player moving
+    addCell(_board.playerIndex());
+    sf::RenderStates copy(sf::BlendNone);
+    copy.texture = &_staticLayer.getTexture();
+    _boardLayer.draw(_background, copy);
+    _boardLayer.draw(_vertices, sf::RenderStates(&_tileClassifier.texture()));
+    _boardLayer.display();
+}
 
-            // check if we pushed a crate that was on a storage location (HOLE_CRATES)
-            // if so, restore the storage location, otherwise use regular floor
-            if (isOnTopOfStorageLocation(playerPos)) {
-                _gameBoard[indexPlayer] = _outline;
-            } else {
-                _gameBoard[indexPlayer] = _floor;
-            }
-            savePlayerLoc(newPlayerPos);
-            savePlayerDirection(dir);
-            moveMade = true;
-        }
-    } else if (_gameBoard[indexNewPlayer].type == TileType::WALLS) {
-        // cannot move into a wall
+void Sokoban::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    if (_hasLayers) {
+        target.draw(sf::Sprite(_boardLayer.getTexture()), states);
         return;
-    } else {
-        // no objects in the way
-        _gameBoard[indexNewPlayer] = TileClassifier::getAnimation(dir, _frameIndex);
-        // Check if player was standing on storage location and restore it if needed
-        if (isOnTopOfStorageLocation(playerPos)) {
-            _gameBoard[indexPlayer] = _outline;
-        } else {
-            _gameBoard[indexPlayer] = _floor;
+    }
+    // without render textures, draw the whole board as one triangle list
+    _vertices.clear();
+    for (unsigned int y = 0; y < height(); y++) {
+        for (unsigned int x = 0; x < width(); x++) {
+            _addStaticTiles(&_vertices, x, y);
+            _addDynamicTile(&_vertices, x, y);
         }
-        savePlayerLoc(newPlayerPos);
-        savePlayerDirection(dir);
-        moveMade = true;
     }
+    states.texture = &_tileClassifier.texture();
+    target.draw(_vertices, states);
+}
 
-    // count moves when player moves
-    if (moveMade) {
-        _moveCount++;
-        _saveState();
+bool Sokoban::updateAssets() {
+    if (!_tileClassifier.update()) {
+        return false;
     }
+    _renderLayers();
+    return true;
+}
 
-    while (!_redoStack.empty()) {
-        _redoStack.pop();
+sf::Vector2u Sokoban::playerLoc() const {
+    Position playerLocation = _board.playerLoc();
+    return {playerLocation.x, playerLocation.y};
+}
+
+void Sokoban::movePlayer(Direction dir) {
+    Direction lastDir = _board.playerDirection();
+    unsigned int pushes = _board.getPushCount();
+    if (_board.movePlayer(dir)) {
+        _recorder.record(dir, _board.getPushCount() != pushes);
+        _player = _tileClassifier.getAnimation(dir, lastDir, _frameIndex);
+        _renderCells(_board.changedCells());
     }
 }
 
-bool Sokoban::isWon() const {
-    if (_storagePositions.empty()) {
-        return true;
+bool Sokoban::walkTo(Position target) {
+    std::string moves;
+    if (!_board.walkTo(target, &moves)) {
+        return false;
     }
-    if (_boxCount == 0) {
-        return true;
+    _recordPath(moves);
+    return true;
+}
+
+bool Sokoban::pushTo(Position crate, Position target) {
+    std::string moves;
+    if (!_board.pushTo(crate, target, &moves)) {
+        return false;
     }
-    unsigned int matchedCount = 0;
-    for (const auto& storagePos : _storagePositions) {
-        if (_gameBoard[storagePos.y * width() + storagePos.x].type == TileType::HOLE_CRATES) {
-            matchedCount += 1;
+    _recordPath(moves);
+    return true;
+}
+
+void Sokoban::_recordPath(const std::string& moves) {
+    Direction dir;
+    for (char c : moves) {
+        if (fromLurd(c, &dir)) {
+            _recorder.record(dir, c >= 'A' && c <= 'Z');
         }
     }
-    if (_boxCount >= _storagePositions.size()) {
-        return matchedCount == _storagePositions.size();
-    } else {
-        return matchedCount == _boxCount;
-    }
+    _syncPlayer();
+    _renderCells(_board.changedCells());
 }
 
 void Sokoban::reset() {
-    _gameBoard = _initialBoard;
-    _moveCount = 0;
-    while (!_undoStack.empty()) {
-        _undoStack.pop();
-    }
-    while (!_redoStack.empty()) {
-        _redoStack.pop();
-    }
-    _saveState();
+    _board.reset();
+    _recorder.restart();
+    _player = _tileClassifier.createTile(static_cast<char>(TileType::PLAYER));
+    _renderBoard();
 }
 
 void Sokoban::undo() {
-    if (_stack.size() == 1) {
-        return;
+    // a walk or push to a cell undoes as a whole, the recorder steps back over every move
+    unsigned int moves = _board.getMoveCount();
+    _board.undo();
+    for (unsigned int i = _board.getMoveCount(); i < moves; i++) {
+        _recorder.undo();
     }
-    _saveStateRedo();
-    _stack.pop();
-    _undoStack = _stack;
-    if (_undoStack.empty()) {
-        return;
-    }
-    _gameBoard = _undoStack.top().gameBoard;
-    savePlayerLoc(_undoStack.top().playerPosition);
-    savePlayerDirection(_undoStack.top().playerDirection);
-    _moveCount = _undoStack.top().moveCount;
-    _undoStack.pop();
+    _syncPlayer();
+    _renderCells(_board.changedCells());
 }
 
 void Sokoban::redo() {
-    if (_redoStack.empty()) {
-        return;
+    unsigned int moves = _board.getMoveCount();
+    _board.redo();
+    for (unsigned int i = moves; i < _board.getMoveCount(); i++) {
+        _recorder.redo();
     }
-    _saveStateUndo();
-    _gameBoard = _redoStack.top().gameBoard;
-    savePlayerLoc(_redoStack.top().playerPosition);
-    savePlayerDirection(_redoStack.top().playerDirection);
-    _moveCount = _redoStack.top().moveCount;
-    _saveState();
-    _redoStack.pop();
+    _syncPlayer();
+    _renderCells(_board.changedCells());
 }
 
-std::istream& operator>>(std::istream& in, Sokoban& game) {
-    game._storagePositions.clear();
-    game._gameBoard.clear();
-    game._boxCount = 0;
-
-    std::string line;
-    std::getline(in, line);
-    std::istringstream iss(line);
-    iss >> game._height >> game._width;
-
-    if (game.width() <= 0 || game.height() <= 0) {
-        throw std::runtime_error("Invalid dimensions");
+bool Sokoban::jumpTo(size_t move) {
+    unsigned int moves = _board.getMoveCount();
+    if (!_board.jumpTo(move)) {
+        return false;
+    }
+    for (unsigned int i = _board.getMoveCount(); i < moves; i++) {
+        _recorder.undo();
+    }
+    for (unsigned int i = moves; i < _board.getMoveCount(); i++) {
+        _recorder.redo();
     }
-    game._gameBoard.resize(game.width() * game.height());
+    _syncPlayer();
+    _renderCells(_board.changedCells());
+    return true;
+}
 
-    unsigned int lineCount = 0;
-    while (std::getline(in, line) && lineCount < game.height()) {
-        for (unsigned int i = 0; i < line.size() && i < game.width(); i++) {
-            Tile tile = game._tileClassifier.createTile(line[i], game._seed);
-            if (tile.type == TileType::PLAYER) {
-                game.savePlayerLoc({i, lineCount});
-                game.savePlayerDirection(Direction::Down);
-            }
-            if (tile.type == TileType::GROUND_OUTLINES) {
-                game._outline = tile;
-                game._storagePositions.push_back({i, lineCount});
-            }
-            if (tile.type == TileType::HOLE_CRATES) {
-                game._storagePositions.push_back({i, lineCount});
-                game._boxCount++;
-            }
-            if (tile.type == TileType::CRATES) {
-                game._boxCount++;
-            }
-            game._gameBoard[lineCount * game.width() + i] = tile;
-        }
-        lineCount++;
+Sokoban::PreparedLevel Sokoban::prepare(Board board, unsigned int seed) {
+    PreparedLevel level;
+    level.board = std::move(board);
+    level.board.setHistoryBudget(HISTORY_BUDGET);
+    // a small generator run from the seed, so a seed always shows the same floor
+    uint32_t state = seed;
+    level.variants.resize(level.board.size());
+    for (uint8_t& variant : level.variants) {
+        state = state * 1664525u + 1013904223u;
+        variant = static_cast<uint8_t>(state >> 24);
     }
-    game._initialBoard = game._gameBoard;
-    game._moveCount = 0;
-    game._saveState();
+    return level;
+}
+
+void Sokoban::load(const Board& board) {
+    load(prepare(board, *_seed));
+}
+
+void Sokoban::load(PreparedLevel level) {
+    Trace::Scope scope("start level", "load");
+    _board = std::move(level.board);
+    _variants = std::move(level.variants);
+    _recorder.restart();
+    _player = _tileClassifier.createTile(static_cast<char>(TileType::PLAYER));
+    _renderLayers();
+}
+
+std::istream& operator>>(std::istream& in, Sokoban& game) {
+    Board board;
+    in >> board;
+    game.load(board);
     return in;
 }
 
 std::ostream& operator<<(std::ostream& out, const Sokoban& game) {
-    out << game.height() << " " << game.width() << std::endl;
-    for (unsigned int y = 0; y < game.height(); y++) {
-        for (unsigned int x = 0; x < game.width(); x++) {
-            unsigned int i = y * game.width() + x;
-            out << static_cast<char>(game._gameBoard[i].type);
-        }
-        out << std::endl;
-    }
-    return out;
+    return out << game._board;
 }
 }  // namespace SB
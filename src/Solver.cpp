@@ -0,0 +1,494 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include <algorithm>
+#include <queue>
+#include "sokoban/Solver.hpp"
+#include "sokoban/Trace.hpp"
+
+namespace SB {
+namespace {
+// splitmix64, a fixed seed keeps the Zobrist keys identical between runs
+uint64_t nextKey(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+}  // namespace
+
+const char* toString(Solution::Status status) {
+    switch (status) {
+        case Solution::Status::Solved:       return "solved";
+        case Solution::Status::Unsolvable:   return "unsolvable";
+        case Solution::Status::LimitReached: return "node-limit";
+        case Solution::Status::TimedOut:     return "timeout";
+        case Solution::Status::OutOfMemory:  return "memory-limit";
+    }
+    return "unknown";
+}
+
+Solver::Solver(const Board& board, SolverOptions options) : _options(options) {
+    _width = board.width() + 2;
+    _height = board.height() + 2;
+    const int width = static_cast<int>(_width);
+    // same order as Direction: Up, Down, Left, Right
+    _offsets[0] = -width;
+    _offsets[1] = width;
+    _offsets[2] = -1;
+    _offsets[3] = 1;
+
+    size_t cells = static_cast<size_t>(_width) * _height;
+    _walls.assign(cells, 1);
+    _goals.assign(cells, 0);
+    for (unsigned int y = 0; y < board.height(); y++) {
+        for (unsigned int x = 0; x < board.width(); x++) {
+            uint32_t cell = _cell(x, y);
+            TileType type = board.at(x, y);
+            _goals[cell] = board.isStorageLocation({x, y});
+            _walls[cell] = type == TileType::WALLS;
+            if (isCrate(type)) {
+                _startCrates.push_back(cell);
+            }
+        }
+    }
+    Position player = board.playerLoc();
+    _startPlayer = _cell(player.x, player.y);
+
+    unsigned int boxes = board.boxCount();
+    unsigned int storage = board.storageCount();
+    _targets = std::min(boxes, storage);
+    _alreadyWon = board.isWon();
+
+    uint64_t seed = 0x5EED;
+    _crateKeys.resize(cells);
+    _playerKeys.resize(cells);
+    for (size_t i = 0; i < cells; i++) {
+        _crateKeys[i] = nextKey(&seed);
+        _playerKeys[i] = nextKey(&seed);
+    }
+
+    size_t tableSize = 1;
+    while (tableSize < _options.tableSize) {
+        tableSize <<= 1;
+    }
+    // leave most of a memory cap to the open list
+    while (_options.maxMemory && tableSize > 1024 &&
+           tableSize * sizeof(Entry) > _options.maxMemory / 4) {
+        tableSize >>= 1;
+    }
+    _table.assign(tableSize, Entry{0, 0, 0});
+
+    _occupied.assign(cells, 0);
+    _reach.assign(cells, 0);
+    _reachStamp.assign(cells, 0);
+    _queue.resize(cells);
+
+    // the level analysis already knows the push distances, copy them onto the padded board
+    _analysis = board.analysis();
+    _boardWidth = board.width();
+    _pushDistance.assign(cells, NONE);
+    for (unsigned int y = 0; y < board.height(); y++) {
+        for (unsigned int x = 0; x < board.width(); x++) {
+            _pushDistance[_cell(x, y)] = _analysis.pushDistance(y * _boardWidth + x);
+        }
+    }
+}
+
+void Solver::_flood(uint32_t player) {
+    // breadth first walk of the player around the crates in _occupied
+    if (++_stamp == 0) {
+        std::fill(_reachStamp.begin(), _reachStamp.end(), 0);
+        _stamp = 1;
+    }
+    size_t head = 0, tail = 0;
+    _queue[tail++] = player;
+    _reach[player] = 0;
+    _reachStamp[player] = _stamp;
+    _reachMin = player;
+    while (head < tail) {
+        uint32_t cell = _queue[head++];
+        for (int d = 0; d < 4; d++) {
+            uint32_t next = cell + _offsets[d];
+            if (_walls[next] || _occupied[next] || _reachStamp[next] == _stamp) {
+                continue;
+            }
+            _reach[next] = _reach[cell] + 1;
+            _reachStamp[next] = _stamp;
+            _reachMin = std::min(_reachMin, next);
+            _queue[tail++] = next;
+        }
+    }
+}
+
+uint32_t Solver::_heuristic(const uint32_t* crates) const {
+    size_t count = _startCrates.size();
+    if (_targets == count) {
+        uint32_t sum = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (_pushDistance[crates[i]] == NONE) {
+                return NONE;
+            }
+            sum += _pushDistance[crates[i]];
+        }
+        return sum;
+    }
+    // with spare crates only the closest ones have to reach the goals
+    std::vector<uint32_t> distances;
+    distances.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        distances.push_back(_pushDistance[crates[i]]);
+    }
+    std::partial_sort(distances.begin(), distances.begin() + _targets, distances.end());
+    uint32_t sum = 0;
+    for (size_t i = 0; i < _targets; i++) {
+        if (distances[i] == NONE) {
+            return NONE;
+        }
+        sum += distances[i];
+    }
+    return sum;
+}
+
+bool Solver::_isSolved(const uint32_t* crates) const {
+    unsigned int matched = 0;
+    for (size_t i = 0; i < _startCrates.size(); i++) {
+        matched += _goals[crates[i]];
+    }
+    return matched >= _targets;
+}
+
+uint64_t Solver::_key(uint64_t crateKey, uint32_t player) const {
+    // counting pushes, every cell the player can walk to is the same state
+    bool byRegion = _options.objective == SolverOptions::Objective::Pushes;
+    return crateKey ^ _playerKeys[byRegion ? _reachMin : player];
+}
+
+bool Solver::_visit(uint64_t key, uint32_t g) {
+    // returns false if this state was already reached as cheaply, replaces
+    // the oldest of a few neighbouring slots when they are all taken
+    size_t mask = _table.size() - 1;
+    size_t index = key & mask;
+    size_t victim = index;
+    for (size_t probe = 0; probe < 4; probe++) {
+        Entry& entry = _table[(index + probe) & mask];
+        if (entry.stamp == _iteration && entry.key == key) {
+            if (entry.g <= g) {
+                return false;
+            }
+            entry.g = g;
+            return true;
+        }
+        if (entry.stamp != _iteration) {
+            victim = (index + probe) & mask;
+            break;
+        }
+    }
+    _table[victim] = Entry{key, g, _iteration};
+    return true;
+}
+
+void Solver::_pushes(const uint32_t* crates, std::vector<Push>* out) const {
+    // every push the player can reach from the last _flood
+    out->clear();
+    for (size_t i = 0; i < _startCrates.size(); i++) {
+        uint32_t crate = crates[i];
+        for (int d = 0; d < 4; d++) {
+            uint32_t to = crate + _offsets[d];
+            uint32_t behind = crate - _offsets[d];
+            uint32_t walk = _distance(behind);
+            if (walk == NONE || _walls[to] || _occupied[to]) {
+                continue;
+            }
+            if (_targets == _startCrates.size() &&
+                (_pushDistance[to] == NONE || (!_goals[to] && _freezes(crate, to)))) {
+                continue;  // the crate could never reach a goal from there
+            }
+            out->push_back({crate, static_cast<uint8_t>(d), walk + 1});
+        }
+    }
+}
+
+bool Solver::_freezes(uint32_t crate, uint32_t to) const {
+    // the analysis works on the board without the wall ring
+    auto unpadded = [this](uint32_t cell) {
+        return static_cast<size_t>(cell / _width - 1) * _boardWidth + cell % _width - 1;
+    };
+    auto isCrate = [this, crate, to](size_t i) {
+        uint32_t cell = _cell(i % _boardWidth, i / _boardWidth);
+        return cell == to || (cell != crate && _occupied[cell]);
+    };
+    return _analysis.isFrozen(unpadded(to), isCrate);
+}
+
+bool Solver::_limitReached() {
+    if (_limit != Solution::Status::Unsolvable) {
+        return true;
+    }
+    if (_options.maxNodes && _expanded >= _options.maxNodes) {
+        _limit = Solution::Status::LimitReached;
+    } else if (_options.maxMemory && _memory > _options.maxMemory) {
+        _limit = Solution::Status::OutOfMemory;
+    } else if (_options.timeLimit > 0 && (_expanded & 255) == 0 &&
+               std::chrono::steady_clock::now() > _deadline) {
+        // reading the clock every expansion would cost more than the check is worth
+        _limit = Solution::Status::TimedOut;
+    }
+    return _limit != Solution::Status::Unsolvable;
+}
+
+Solution Solver::solve() {
+    Trace::Scope scope("solve", "solver");
+    _expanded = 0;
+    _limit = Solution::Status::Unsolvable;
+    _memory = _table.size() * sizeof(Entry);
+    _deadline = std::chrono::steady_clock::now() +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(_options.timeLimit));
+    if (_alreadyWon) {
+        Solution solution;
+        solution.status = Solution::Status::Solved;
+        solution.optimal = true;
+        return solution;
+    }
+    if (_options.algorithm == SolverOptions::Algorithm::IDAStar) {
+        return _idaStar();
+    }
+    return _aStar();
+}
+
+Solution Solver::_aStar() {
+    struct Open {
+      uint32_t f;
+      uint32_t g;
+      uint32_t node;
+      bool operator<(const Open& o) const {
+          // lowest f first, deeper states first on ties
+          return f != o.f ? f > o.f : g < o.g;
+      }
+    };
+    const size_t count = _startCrates.size();
+    const bool byPushes = _options.objective == SolverOptions::Objective::Pushes;
+    _iteration++;
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> arena(_startCrates);
+    std::priority_queue<Open> open;
+    std::vector<Push> pushes;
+    std::vector<uint32_t> parent;
+
+    uint32_t h = _heuristic(_startCrates.data());
+    Solution solution;
+    if (h == NONE) {
+        return solution;
+    }
+    nodes.push_back({NONE, _startPlayer, 0, 0});
+    open.push({static_cast<uint32_t>(_options.weight * h), 0, 0});
+
+    while (!open.empty()) {
+        Open top = open.top();
+        open.pop();
+        const Node node = nodes[top.node];
+        uint32_t* crates = &arena[static_cast<size_t>(top.node) * count];
+        uint64_t crateKey = 0;
+        for (size_t i = 0; i < count; i++) {
+            crateKey ^= _crateKeys[crates[i]];
+            _occupied[crates[i]] = 1;
+        }
+        _flood(node.crate);
+        bool fresh = _visit(_key(crateKey, node.crate), node.g);
+        if (fresh && _isSolved(crates)) {
+            for (size_t i = 0; i < count; i++) {
+                _occupied[crates[i]] = 0;
+            }
+            std::vector<std::pair<uint32_t, uint8_t>> path;
+            for (uint32_t n = top.node; nodes[n].parent != NONE; n = nodes[n].parent) {
+                path.push_back({nodes[n].crate, nodes[n].dir});
+            }
+            std::reverse(path.begin(), path.end());
+            solution = _finish(path);
+            solution.optimal = _options.weight <= 1.0;
+            return solution;
+        }
+        if (fresh) {
+            _expanded++;
+            _pushes(crates, &pushes);
+        } else {
+            pushes.clear();
+        }
+        for (size_t i = 0; i < count; i++) {
+            _occupied[crates[i]] = 0;
+        }
+
+        // the arena moves while children are appended, so work on a copy
+        parent.assign(crates, crates + count);
+        for (const Push& push : pushes) {
+            uint32_t to = push.crate + _offsets[push.dir];
+            uint32_t g = node.g + (byPushes ? 1 : push.cost);
+            size_t base = arena.size();
+            arena.insert(arena.end(), parent.begin(), parent.end());
+            uint32_t* child = &arena[base];
+            for (size_t i = 0; i < count; i++) {
+                if (child[i] == push.crate) {
+                    child[i] = to;
+                    break;
+                }
+            }
+            uint32_t childH = _heuristic(child);
+            if (childH == NONE) {
+                arena.resize(base);
+                continue;
+            }
+            uint32_t id = static_cast<uint32_t>(nodes.size());
+            nodes.push_back({top.node, push.crate, g, push.dir});
+            open.push({g + static_cast<uint32_t>(_options.weight * childH), g, id});
+        }
+        _memory = nodes.size() * sizeof(Node) + arena.size() * sizeof(uint32_t) +
+                  open.size() * sizeof(Open) + _table.size() * sizeof(Entry);
+        if (_limitReached()) {
+            solution.status = _limit;
+            break;
+        }
+    }
+    solution.nodesExpanded = _expanded;
+    return solution;
+}
+
+Solution Solver::_idaStar() {
+    std::vector<uint32_t> crates(_startCrates);
+    uint64_t crateKey = 0;
+    for (uint32_t crate : crates) {
+        crateKey ^= _crateKeys[crate];
+        _occupied[crate] = 1;
+    }
+    Solution solution;
+    uint32_t h = _heuristic(crates.data());
+    if (h == NONE) {
+        return solution;
+    }
+    uint32_t bound = static_cast<uint32_t>(_options.weight * h);
+    std::vector<std::pair<uint32_t, uint8_t>> path;
+    while (true) {
+        // a new iteration makes every table entry stale
+        _iteration++;
+        uint32_t next = NONE;
+        if (_idaSearch(&crates, crateKey, _startPlayer, 0, bound, &next, &path)) {
+            for (uint32_t crate : crates) {
+                _occupied[crate] = 0;
+            }
+            solution = _finish(path);
+            solution.optimal = _options.weight <= 1.0;
+            return solution;
+        }
+        if (_limitReached()) {
+            solution.status = _limit;
+            break;
+        }
+        if (next == NONE) {
+            break;
+        }
+        bound = next;
+    }
+    for (uint32_t crate : crates) {
+        _occupied[crate] = 0;
+    }
+    solution.nodesExpanded = _expanded;
+    return solution;
+}
+
+bool Solver::_idaSearch(std::vector<uint32_t>* crates, uint64_t crateKey, uint32_t player,
+                        uint32_t g, uint32_t bound, uint32_t* next,
+                        std::vector<std::pair<uint32_t, uint8_t>>* path) {
+    uint32_t h = _heuristic(crates->data());
+    // with spare crates a push onto a dead square gets this far, see _pushes
+    if (h == NONE) {
+        return false;
+    }
+    uint32_t f = g + static_cast<uint32_t>(_options.weight * h);
+    if (f > bound) {
+        *next = std::min(*next, f);
+        return false;
+    }
+    _flood(player);
+    if (!_visit(_key(crateKey, player), g)) {
+        return false;
+    }
+    if (_isSolved(crates->data())) {
+        return true;
+    }
+    if (_limitReached()) {
+        return false;
+    }
+    _expanded++;
+
+    // the flood is overwritten by the recursion, so collect the pushes first
+    std::vector<Push> pushes;
+    _pushes(crates->data(), &pushes);
+    const bool byPushes = _options.objective == SolverOptions::Objective::Pushes;
+    for (const Push& push : pushes) {
+        uint32_t to = push.crate + _offsets[push.dir];
+        auto it = std::find(crates->begin(), crates->end(), push.crate);
+        *it = to;
+        _occupied[push.crate] = 0;
+        _occupied[to] = 1;
+        path->push_back({push.crate, push.dir});
+        uint64_t childKey = crateKey ^ _crateKeys[push.crate] ^ _crateKeys[to];
+        uint32_t cost = byPushes ? 1 : push.cost;
+        bool found = _idaSearch(crates, childKey, push.crate, g + cost, bound, next, path);
+        if (found) {
+            return true;
+        }
+        path->pop_back();
+        _occupied[to] = 0;
+        _occupied[push.crate] = 1;
+        *it = push.crate;
+    }
+    return false;
+}
+
+Solution Solver::_finish(const std::vector<std::pair<uint32_t, uint8_t>>& path) {
+    // replay the pushes, walking the player along a shortest path to each one
+    Solution solution;
+    solution.status = Solution::Status::Solved;
+    solution.nodesExpanded = _expanded;
+
+    std::vector<uint32_t> crates(_startCrates);
+    for (uint32_t crate : crates) {
+        _occupied[crate] = 1;
+    }
+    uint32_t player = _startPlayer;
+    std::string walk;
+    for (const auto& push : path) {
+        uint32_t crate = push.first;
+        int dir = push.second;
+        uint32_t behind = crate - _offsets[dir];
+        _flood(behind);
+        // step from the player back towards `behind` along decreasing distances
+        walk.clear();
+        uint32_t cell = player;
+        while (cell != behind) {
+            for (int d = 0; d < 4; d++) {
+                uint32_t nextCell = cell + _offsets[d];
+                if (_distance(nextCell) != NONE && _distance(nextCell) + 1 == _distance(cell)) {
+                    walk += toLurd(static_cast<Direction>(d), false);
+                    cell = nextCell;
+                    break;
+                }
+            }
+        }
+        solution.moves += walk;
+        solution.moves += toLurd(static_cast<Direction>(dir), true);
+        uint32_t to = crate + _offsets[dir];
+        *std::find(crates.begin(), crates.end(), crate) = to;
+        _occupied[crate] = 0;
+        _occupied[to] = 1;
+        player = crate;
+    }
+    for (uint32_t crate : crates) {
+        _occupied[crate] = 0;
+    }
+    solution.moveCount = static_cast<unsigned int>(solution.moves.size());
+    solution.pushCount = static_cast<unsigned int>(path.size());
+    return solution;
+}
+}  // namespace SB
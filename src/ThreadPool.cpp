@@ -0,0 +1,122 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include "sokoban/ThreadPool.hpp"
+#include <string>
+#include <utility>
+#include "sokoban/Trace.hpp"
+
+namespace SB {
+namespace {
+// lets a task submitted from a worker land on that worker's own deque
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local size_t currentIndex = 0;
+}  // namespace
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+    for (size_t i = 0; i < threads; i++) {
+        _queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < threads; i++) {
+        _threads.emplace_back(&ThreadPool::_run, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _wake.notify_all();
+    for (std::thread& thread : _threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    size_t index;
+    {
+        // counting under the lock keeps a sleeping worker from missing the wake up
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pending++;
+        _queued++;
+        index = currentPool == this ? currentIndex : _next++ % _queues.size();
+    }
+    {
+        std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+        _queues[index]->tasks.push_back(std::move(task));
+    }
+    _wake.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this] { return _pending == 0; });
+    if (_error) {
+        std::exception_ptr error = _error;
+        _error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+bool ThreadPool::_take(size_t index, std::function<void()>* task) {
+    {
+        Queue& own = *_queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            *task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < _queues.size(); i++) {
+        Queue& other = *_queues[(index + i) % _queues.size()];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (!other.tasks.empty()) {
+            *task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::_run(size_t index) {
+    currentPool = this;
+    currentIndex = index;
+    Trace::instance().setThreadName("pool worker " + std::to_string(index));
+    std::function<void()> task;
+    while (true) {
+        if (_take(index, &task)) {
+            _queued--;
+            std::exception_ptr error;
+            try {
+                Trace::Scope scope("task", "pool");
+                task();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            task = nullptr;
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (error && !_error) {
+                _error = error;
+            }
+            if (--_pending == 0) {
+                _idle.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_mutex);
+        _wake.wait(lock, [this] { return _stopping || _queued > 0; });
+        if (_stopping && _queued == 0) {
+            return;
+        }
+    }
+}
+}  // namespace SB
@@ -0,0 +1,55 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include "sokoban/TileAtlas.hpp"
+#include <algorithm>
+
+namespace SB {
+size_t TileAtlas::add(const sf::Image& image) {
+    _images.push_back(image);
+    _regions.emplace_back();
+    return _regions.size() - 1;
+}
+
+bool TileAtlas::build() {
+    unsigned int maxWidth = std::min(sf::Texture::getMaximumSize(), MAX_WIDTH);
+
+    // shelf packing: fill rows left to right, start a new row when one is full
+    unsigned int x = 0, y = 0, rowHeight = 0, atlasWidth = 1;
+    for (size_t i = 0; i < _images.size(); i++) {
+        sf::Vector2u size = _images[i].getSize();
+        unsigned int width = size.x + 2 * PADDING;
+        unsigned int height = size.y + 2 * PADDING;
+        if (x + width > maxWidth) {
+            x = 0;
+            y += rowHeight;
+            rowHeight = 0;
+        }
+        _regions[i] = sf::IntRect(x + PADDING, y + PADDING, size.x, size.y);
+        x += width;
+        rowHeight = std::max(rowHeight, height);
+        atlasWidth = std::max(atlasWidth, x);
+    }
+    unsigned int atlasHeight = std::max(y + rowHeight, 1u);
+    if (atlasWidth > maxWidth || atlasHeight > sf::Texture::getMaximumSize()) {
+        return false;
+    }
+
+    sf::Image atlas;
+    atlas.create(atlasWidth, atlasHeight, sf::Color::Transparent);
+    for (size_t i = 0; i < _images.size(); i++) {
+        const sf::Image& image = _images[i];
+        const sf::IntRect& r = _regions[i];
+        int w = r.width, h = r.height;
+        atlas.copy(image, r.left, r.top);
+        // repeat the edges into the padding
+        atlas.copy(image, r.left - 1, r.top, sf::IntRect(0, 0, 1, h));
+        atlas.copy(image, r.left + w, r.top, sf::IntRect(w - 1, 0, 1, h));
+        atlas.copy(image, r.left, r.top - 1, sf::IntRect(0, 0, w, 1));
+        atlas.copy(image, r.left, r.top + h, sf::IntRect(0, h - 1, w, 1));
+    }
+    _images.clear();
+    _images.shrink_to_fit();
+    return _texture.loadFromImage(atlas);
+}
+}  // namespace SB
@@ -0,0 +1,154 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include "sokoban/Trace.hpp"
+#include <stdexcept>
+#include <utility>
+
+namespace SB {
+thread_local Trace::Buffer* Trace::_current = nullptr;
+
+namespace {
+std::string escape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += static_cast<unsigned char>(c) < 0x20 ? ' ' : c;
+    }
+    return escaped;
+}
+}  // namespace
+
+Trace& Trace::instance() {
+    // never destroyed, the workers of other singletons may record while statics are torn down
+    static Trace* trace = new Trace();
+    return *trace;
+}
+
+void Trace::start(const std::string& filename) {
+    stop();
+    std::lock_guard<std::mutex> lock(_mutex);
+    _out.open(filename, std::ios::trunc);
+    if (!_out.is_open()) {
+        throw std::runtime_error("Failed to open " + filename);
+    }
+    _out << "{\"traceEvents\": [\n";
+    // drop what was recorded after a previous trace stopped
+    for (const std::unique_ptr<Buffer>& buffer : _buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.clear();
+    }
+    _full.clear();
+    _first = true;
+    _stopping = false;
+    _origin = Clock::now();
+    _writer = std::thread(&Trace::_write, this);
+    _enabled.store(true, std::memory_order_release);
+}
+
+void Trace::stop() {
+    if (!_enabled.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        // hand over whatever the threads have not filled yet
+        for (const std::unique_ptr<Buffer>& buffer : _buffers) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            if (!buffer->events.empty()) {
+                _full.push_back({buffer->thread, std::move(buffer->events)});
+                buffer->events.clear();
+            }
+        }
+        _stopping = true;
+    }
+    _wake.notify_one();
+    _writer.join();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const std::unique_ptr<Buffer>& buffer : _buffers) {
+        if (!buffer->threadName.empty()) {
+            _out << (_first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", " <<
+                    "\"pid\": 1, \"tid\": " << buffer->thread << ", \"args\": {\"name\": \"" <<
+                    escape(buffer->threadName) << "\"}}";
+            _first = false;
+        }
+    }
+    _out << "\n]}\n";
+    _out.close();
+}
+
+void Trace::complete(const char* name, const char* category,
+                     Clock::time_point start, Clock::time_point end) {
+    if (!enabled()) {
+        return;
+    }
+    Buffer& buffer = _buffer();
+    std::unique_lock<std::mutex> lock(buffer.mutex);
+    if (buffer.events.capacity() == 0) {
+        buffer.events.reserve(BUFFER_SIZE);
+    }
+    buffer.events.push_back({name, category,
+        std::chrono::duration_cast<std::chrono::microseconds>(start - _origin).count(),
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()});
+    if (buffer.events.size() < BUFFER_SIZE) {
+        return;
+    }
+    // full, swap in an empty buffer and let the writer have this one
+    Batch batch{buffer.thread, std::move(buffer.events)};
+    buffer.events = std::vector<Event>();
+    lock.unlock();
+    {
+        std::lock_guard<std::mutex> fullLock(_mutex);
+        _full.push_back(std::move(batch));
+    }
+    _wake.notify_one();
+}
+
+void Trace::setThreadName(const std::string& name) {
+    Buffer& buffer = _buffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.threadName = name;
+}
+
+Trace::Buffer& Trace::_buffer() {
+    if (!_current) {
+        auto buffer = std::make_unique<Buffer>();
+        std::lock_guard<std::mutex> lock(_mutex);
+        buffer->thread = static_cast<uint32_t>(_buffers.size() + 1);
+        _current = buffer.get();
+        _buffers.push_back(std::move(buffer));
+    }
+    return *_current;
+}
+
+void Trace::_write() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _wake.wait(lock, [this] { return _stopping || !_full.empty(); });
+        std::vector<Batch> batches = std::move(_full);
+        _full.clear();
+        bool stopping = _stopping;
+        // the file is written without the lock, so recording threads never wait for it
+        lock.unlock();
+        for (const Batch& batch : batches) {
+            _writeBatch(batch);
+        }
+        lock.lock();
+        if (stopping && _full.empty()) {
+            return;
+        }
+    }
+}
+
+void Trace::_writeBatch(const Batch& batch) {
+    for (const Event& event : batch.events) {
+        _out << (_first ? "" : ",\n") << "{\"name\": \"" << event.name << "\", \"cat\": \"" <<
+                event.category << "\", \"ph\": \"X\", \"ts\": " << event.start <<
+                ", \"dur\": " << event.duration << ", \"pid\": 1, \"tid\": " << batch.thread << "}";
+        _first = false;
+    }
+}
+}  // namespace SB
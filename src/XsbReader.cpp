@@ -0,0 +1,198 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include "sokoban/XsbReader.hpp"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <utility>
+
+namespace SB {
+namespace {
+// rows or columns a level may have, guards against run lengths gone wrong
+const size_t MAX_SIDE = 1024;
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// returns the line without surrounding blanks
+std::string trimmed(const std::string& line) {
+    size_t first = line.find_first_not_of(" \t");
+    if (first == std::string::npos) {
+        return "";
+    }
+    size_t last = line.find_last_not_of(" \t");
+    return line.substr(first, last - first + 1);
+}
+
+// returns true for "Key: value" lines, and puts the key in key
+bool splitField(const std::string& line, std::string* key, std::string* value) {
+    size_t colon = line.find(':');
+    if (colon == 0 || colon == std::string::npos ||
+        line.find_first_of(" \t") < colon) {
+        return false;
+    }
+    *key = line.substr(0, colon);
+    std::transform(key->begin(), key->end(), key->begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    *value = trimmed(line.substr(colon + 1));
+    return true;
+}
+}  // namespace
+
+bool isXsbRow(const std::string& line) {
+    bool wall = false;
+    for (char c : line) {
+        switch (c) {
+            case '#':
+                wall = true;
+                break;
+            case ' ': case '-': case '_': case '.': case '$': case '*': case '@': case '+':
+            case 'p': case 'P': case 'b': case 'B': case '|':
+                break;
+            default:
+                if (!isDigit(c)) {
+                    return false;
+                }
+        }
+    }
+    // a run length always comes before the tile it repeats
+    return wall && !isDigit(line.back());
+}
+
+XsbReader::XsbReader(std::istream& in, std::string name)
+    : _in(in), _name(std::move(name)) {}
+
+bool XsbReader::_readLine() {
+    if (_hasLine) {
+        _hasLine = false;
+        return true;
+    }
+    if (!std::getline(_in, _line)) {
+        return false;
+    }
+    if (!_line.empty() && _line.back() == '\r') {
+        _line.pop_back();
+    }
+    return true;
+}
+
+bool XsbReader::next(BatchLevel* level) {
+    std::string key, value;
+    // skip to the first row of the board, text on the way may name it
+    bool found = false;
+    while (_readLine()) {
+        if (isXsbRow(_line)) {
+            found = true;
+            break;
+        }
+        std::string text = trimmed(_line);
+        if (splitField(text, &key, &value)) {
+            if (key == "title") {
+                _pending = value;
+            }
+        } else if (!text.empty() && text[0] == ';') {
+            _pending = trimmed(text.substr(1));
+        } else if (!text.empty()) {
+            _pending = text;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+    std::string title = std::move(_pending);
+    _pending.clear();
+
+    // the board ends at the first line that is not a row, run lengths are expanded here
+    size_t rows = 0;
+    bool more;
+    do {
+        size_t run = 0;
+        bool rowStarted = false;
+        for (char c : _line) {
+            if (!rowStarted) {
+                if (rows == _rows.size()) {
+                    _rows.emplace_back();
+                }
+                _rows[rows].clear();
+                rowStarted = true;
+            }
+            if (isDigit(c)) {
+                run = run * 10 + (c - '0');
+                if (run > MAX_SIDE) {
+                    throw std::runtime_error("Row too long in " + _name);
+                }
+            } else if (c == '|') {
+                rows++;
+                rowStarted = false;
+            } else {
+                _rows[rows].append(std::max<size_t>(run, 1), c);
+                run = 0;
+            }
+        }
+        rows += rowStarted ? 1 : 0;
+        if (rows > MAX_SIDE) {
+            throw std::runtime_error("Too many rows in " + _name);
+        }
+    } while ((more = _readLine()) && isXsbRow(_line));
+    _rows.resize(rows);
+
+    // fields after the board belong to it, until the next board starts
+    bool inComment = false;
+    while (more) {
+        if (isXsbRow(_line) && !inComment) {
+            _hasLine = true;
+            break;
+        }
+        std::string text = trimmed(_line);
+        if (splitField(text, &key, &value)) {
+            if (key == "title") {
+                title = value;
+            } else if (key == "comment") {
+                inComment = value.empty();
+            } else if (key == "comment-end") {
+                inComment = false;
+            }
+        } else if (!text.empty() && !inComment) {
+            _pending = text[0] == ';' ? trimmed(text.substr(1)) : text;
+        }
+        more = _readLine();
+    }
+
+    _count++;
+    _build(level, title.empty() ? _name + "#" + std::to_string(_count) : title);
+    return true;
+}
+
+void XsbReader::_build(BatchLevel* level, const std::string& title) {
+    size_t width = 0;
+    for (const std::string& row : _rows) {
+        width = std::max(width, row.size());
+    }
+    if (width > MAX_SIDE) {
+        throw std::runtime_error("Row too long in " + _name);
+    }
+    _cells.assign(width * _rows.size(), TileType::GROUNDS);
+
+    bool playerOnGoal = false;
+    for (size_t y = 0; y < _rows.size(); y++) {
+        for (size_t x = 0; x < _rows[y].size(); x++) {
+            TileType& cell = _cells[y * width + x];
+            switch (_rows[y][x]) {
+                case '#': cell = TileType::WALLS; break;
+                case '.': cell = TileType::GROUND_OUTLINES; break;
+                case '$': case 'b': cell = TileType::CRATES; break;
+                case '*': case 'B': cell = TileType::HOLE_CRATES; break;
+                case '@': case 'p': cell = TileType::PLAYER; break;
+                case '+': case 'P':
+                    cell = TileType::PLAYER;
+                    playerOnGoal = true;
+                    break;
+                default: break;  // floor
+            }
+        }
+    }
+    level->name = title;
+    level->board = Board(static_cast<unsigned int>(width),
+                         static_cast<unsigned int>(_rows.size()), _cells.data(), playerOnGoal);
+}
+}  // namespace SB
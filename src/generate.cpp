@@ -0,0 +1,141 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "sokoban/Generator.hpp"
+#include "sokoban/ThreadPool.hpp"
+
+namespace {
+// writes one .lvl file per level into a directory, or every level back to
+// back into a single file that loadLevelFile() reads again
+bool writeLevels(const std::string& output, const std::vector<SB::GeneratedLevel>& levels) {
+    if (output.empty()) {
+        for (const SB::GeneratedLevel& level : levels) {
+            std::cout << level.board << std::endl;
+        }
+        return true;
+    }
+    if (!std::filesystem::is_directory(output)) {
+        std::ofstream ofs(output);
+        if (!ofs.is_open()) {
+            std::cerr << "Failed to open " << output << std::endl;
+            return false;
+        }
+        for (const SB::GeneratedLevel& level : levels) {
+            ofs << level.board << std::endl;
+        }
+        return true;
+    }
+    for (size_t i = 0; i < levels.size(); i++) {
+        std::ostringstream name;
+        name << "generated_" << std::setw(4) << std::setfill('0') << i + 1 << ".lvl";
+        std::string filename = (std::filesystem::path(output) / name.str()).string();
+        std::ofstream ofs(filename);
+        if (!ofs.is_open()) {
+            std::cerr << "Failed to open " << filename << std::endl;
+            return false;
+        }
+        ofs << levels[i].board;
+    }
+    return true;
+}
+
+// prints the options, returns the exit code for bad arguments
+int usage(const char* name) {
+    std::cerr << "Usage: " << name << " [--count n] [--size WxH] [--crates n]" <<
+    " [--walls density] [--pulls n] [--seed n]" << std::endl;
+    std::cerr << "       [--min-pushes n] [--max-pushes n] [--min-moves n]" <<
+    " [--min-branching x] [--nodes n] [--candidates n]" << std::endl;
+    std::cerr << "       [--threads n] [--output dir_or_file]" << std::endl;
+    return 1;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    SB::GeneratorOptions options;
+    size_t count = 10;
+    size_t threads = 0;
+    std::string output;
+    bool maxCandidatesSet = false;
+    // a value that does not parse names its option instead of aborting
+    std::string arg;
+    try {
+        for (int i = 1; i < argc; i++) {
+            arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--count" && hasValue) {
+                count = std::stoull(argv[++i]);
+            } else if (arg == "--size" && hasValue) {
+                std::string size = argv[++i];
+                size_t x = size.find('x');
+                options.width = std::stoul(size.substr(0, x));
+                options.height = x == std::string::npos ? options.width
+                                                        : std::stoul(size.substr(x + 1));
+            } else if (arg == "--crates" && hasValue) {
+                options.crates = std::stoul(argv[++i]);
+            } else if (arg == "--walls" && hasValue) {
+                options.wallDensity = std::stod(argv[++i]);
+            } else if (arg == "--pulls" && hasValue) {
+                options.pulls = std::stoul(argv[++i]);
+            } else if (arg == "--seed" && hasValue) {
+                options.seed = std::stoull(argv[++i]);
+            } else if (arg == "--min-pushes" && hasValue) {
+                options.minPushes = std::stoul(argv[++i]);
+            } else if (arg == "--max-pushes" && hasValue) {
+                options.maxPushes = std::stoul(argv[++i]);
+            } else if (arg == "--min-moves" && hasValue) {
+                options.minMoves = std::stoul(argv[++i]);
+            } else if (arg == "--min-branching" && hasValue) {
+                options.minBranching = std::stod(argv[++i]);
+            } else if (arg == "--nodes" && hasValue) {
+                options.maxNodes = std::stoull(argv[++i]);
+            } else if (arg == "--candidates" && hasValue) {
+                options.maxCandidates = std::stoull(argv[++i]);
+                maxCandidatesSet = true;
+            } else if (arg == "--threads" && hasValue) {
+                threads = std::stoull(argv[++i]);
+            } else if (arg == "--output" && hasValue) {
+                output = argv[++i];
+            } else {
+                return usage(argv[0]);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid value for " << arg << ": " << e.what() << std::endl;
+        return usage(argv[0]);
+    }
+    if (!(options.wallDensity >= 0 && options.wallDensity <= 1)) {
+        std::cerr << "--walls must be between 0 and 1" << std::endl;
+        return usage(argv[0]);
+    }
+    if (!maxCandidatesSet) {
+        // do not spin forever on targets no room of this size can meet
+        options.maxCandidates = 1000 * count + 1000;
+    }
+
+    SB::ThreadPool pool(threads);
+    size_t candidates = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SB::GeneratedLevel> levels = SB::generateLevels(options, count, pool, &candidates);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!writeLevels(output, levels)) {
+        return 1;
+    }
+    std::cerr << "kept " << levels.size() << " of " << candidates << " candidates in " <<
+                 std::fixed << std::setprecision(2) << seconds << " s on " << pool.size() <<
+                 " threads" << std::endl;
+    for (const SB::GeneratedLevel& level : levels) {
+        std::cerr << "candidate " << level.candidate << ": " << level.solution.moveCount <<
+                     " moves, " << level.solution.pushCount << " pushes, branching " <<
+                     std::setprecision(2) << level.branching << std::endl;
+    }
+    return levels.size() == count ? 0 : 2;
+}
@@ -7,8 +7,18 @@
 #include <iostream>
 #include <memory>
 #include <fstream>
+#include <future>
+#include <algorithm>
+#include <string>
+#include <vector>
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
+#include "sokoban/AssetCache.hpp"
+#include "sokoban/FrameStats.hpp"
+#include "sokoban/LevelPack.hpp"
+#include "sokoban/Profiler.hpp"
+#include "sokoban/ThreadPool.hpp"
+#include "sokoban/Trace.hpp"
 #include "sokoban/Sokoban.hpp"
 
 #define DELAY 5.0f
@@ -23,77 +33,176 @@ void getMovementInput(
 );
 
 int main(int argc, char* argv[]) {
-    if (argc < 2 || argc > 3) {
-        std::cerr << "Usage: " << argv[0] << " level_file.lvl" << "[seed]" <<
-        std::endl;
+    // frames per second while something animates, the game sleeps otherwise
+    unsigned int frameLimit = 60;
+    bool showStats = false;
+    std::string recordFile;
+    std::string profileFile;
+    std::string traceFile;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--fps" && i + 1 < argc) {
+            frameLimit = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--stats") {
+            showStats = true;
+        } else if (arg == "--record" && i + 1 < argc) {
+            recordFile = argv[++i];
+        } else if (arg == "--profile" && i + 1 < argc) {
+            profileFile = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceFile = argv[++i];
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.empty() || positional.size() > 2) {
+        std::cerr << "Usage: " << argv[0] << " level_file.lvl|levels.pack" << " [seed]" <<
+        " [--fps n] [--stats] [--record moves.log] [--profile phases.csv]" <<
+        " [--trace trace.json]" << std::endl;
         return 1;
     }
 
     unsigned int input_seed;
-    if (argc != 3) {
+    if (positional.size() != 2) {
         input_seed = 0;
     } else {
-        input_seed = std::stoi(argv[2]);
+        input_seed = std::stoi(positional[1]);
     }
     std::shared_ptr<unsigned int> seed = std::make_shared<unsigned int>(input_seed);
-    std::string level_file = argv[1];
+    std::string level_file = positional[0];
+
+    // Chrome trace of frames, level loads and background work, for chrome://tracing
+    SB::Trace& trace = SB::Trace::instance();
+    if (!traceFile.empty()) {
+        trace.start(traceFile);
+        trace.setThreadName("main");
+    }
+
+    // start decoding the font and sound right away, the first frames are drawn without them
+    SB::AssetCache& assets = SB::AssetCache::instance();
+    auto fontHandle = assets.load<sf::Font>("assets/sokoban/Fonts/3270NerdFontRegular.ttf");
+    auto winSoundHandle = assets.load<sf::SoundBuffer>("assets/sokoban/Sounds/win.mp3");
     SB::Sokoban game(seed);
 
-    std::ifstream ifs(level_file, std::ifstream::in);
-    if (!ifs.is_open()) {
-        throw std::runtime_error("Failed to open " + level_file);
+    std::vector<std::string> levels = {
+        "assets/sokoban/Levels/level1.lvl", "assets/sokoban/Levels/level2.lvl",
+        "assets/sokoban/Levels/level3.lvl", "assets/sokoban/Levels/level4.lvl",
+        "assets/sokoban/Levels/level5.lvl", "assets/sokoban/Levels/level6.lvl"
+    };
+
+    // a pack made by sokoban-pack replaces the built in level list
+    std::unique_ptr<SB::LevelPack> pack;
+    if (level_file.size() > 5 && level_file.compare(level_file.size() - 5, 5, ".pack") == 0) {
+        pack = std::make_unique<SB::LevelPack>(level_file);
+        if (pack->size() == 0) {
+            throw std::runtime_error(level_file + " has no levels");
+        }
+    }
+    size_t levelCount = pack ? pack->size() : levels.size();
+    // reads and analyses a level without touching the game, so it can run on
+    // the loader thread while the current level is still shown
+    auto readLevel = [&pack, &levels, &level_file](size_t i) {
+        SB::Trace::Scope scope("load level", "load");
+        if (pack) {
+            return pack->board(i);
+        }
+        const std::string& path = i == 0 ? level_file : levels[i];
+        std::ifstream ifs(path, std::ifstream::in);
+        if (!ifs.is_open()) {
+            throw std::runtime_error("Failed to open " + path);
+        }
+        SB::Board board;
+        ifs >> board;
+        return board;
+    };
+    unsigned int level = 0;
+    game.load(SB::Sokoban::prepare(readLevel(level), *seed));
+
+    // the next level is prepared here during the win countdown and swapped in
+    // when it ends, so the switch only builds the render layers
+    SB::ThreadPool loader(1);
+    std::future<SB::Sokoban::PreparedLevel> nextLevel;
+    auto prepareLevel = [&](size_t i) {
+        auto promise = std::make_shared<std::promise<SB::Sokoban::PreparedLevel>>();
+        nextLevel = promise->get_future();
+        unsigned int levelSeed = *seed;
+        loader.submit([&readLevel, promise, i, levelSeed] {
+            try {
+                promise->set_value(SB::Sokoban::prepare(readLevel(i), levelSeed));
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        });
+    };
+
+    // appends "level<TAB>result<TAB>moves<TAB>times" for every attempt that moved
+    std::ofstream recordOut;
+    if (!recordFile.empty()) {
+        recordOut.open(recordFile, std::ios::app);
+        if (!recordOut.is_open()) {
+            throw std::runtime_error("Failed to open " + recordFile);
+        }
     }
-    ifs >> game;
+    auto levelName = [&](size_t i) -> std::string {
+        return pack ? std::string(pack->level(i).name) : (i == 0 ? level_file : levels[i]);
+    };
+    auto saveRecording = [&]() {
+        if (recordOut.is_open() && game.getMoveCount() > 0) {
+            recordOut << levelName(level) << '\t' << (game.isWon() ? "won" : "unfinished") <<
+                         '\t' << game.recording() << std::endl;
+        }
+    };
 
     sf::RenderWindow window(sf::VideoMode(game.pixelWidth(),
                                           game.pixelHeight()),
                                           "Sokoban!",
                                           sf::Style::Titlebar);
 
-    // set up font
-    sf::Font font;
-    if (!font.loadFromFile("assets/sokoban/Fonts/3270NerdFontRegular.ttf")) {
-        if (!font.loadFromFile("3270NerdFontRegular.ttf")) {
-            throw std::runtime_error("Failed to load font");
-        }
-    }
+    // the font is set on every text once it finished loading
+    std::shared_ptr<const sf::Font> font;
 
     // set up move counter text
     sf::Text moveCounterText;
-    moveCounterText.setFont(font);
     moveCounterText.setCharacterSize(24);
     moveCounterText.setFillColor(sf::Color::White);
     moveCounterText.setPosition(10, 10);
     moveCounterText.setString("Moves: 0");
 
+    // set up the profiler overlay, toggled with F3
+    sf::Text profileText;
+    profileText.setCharacterSize(14);
+    profileText.setFillColor(sf::Color::Yellow);
+    profileText.setPosition(10, 40);
+    bool showProfile = false;
+
     // set up win message text
     sf::Text winText;
-    winText.setFont(font);
     winText.setCharacterSize(48);
     winText.setFillColor(sf::Color::Green);
     winText.setString("You Win!");
 
     // set up timer text
     sf::Text timerText;
-    timerText.setFont(font);
     timerText.setCharacterSize(24);
     timerText.setFillColor(sf::Color::Green);
 
     // set up time elapsed text
     sf::Text elapsedText;
-    elapsedText.setFont(font);
     elapsedText.setCharacterSize(24);
     elapsedText.setFillColor(sf::Color::Green);
 
-    // set up win sound
-    sf::SoundBuffer winSoundBuffer;
-    if (!winSoundBuffer.loadFromFile("win.mp3")) {
-        if (!winSoundBuffer.loadFromFile("assets/sokoban/Sounds/win.mp3")) {
-            throw std::runtime_error("Failed to load win sound");
-        }
-    }
+    // set up win sound, the buffer is set once it finished loading
+    std::shared_ptr<const sf::SoundBuffer> winSoundBuffer;
     sf::Sound winSound;
-    winSound.setBuffer(winSoundBuffer);
+
+    // a clicked crate stays selected until the next click pushes it there
+    bool crateSelected = false;
+    SB::Position selectedCrate{0, 0};
+    sf::RectangleShape selection(sf::Vector2f(SB::Sokoban::TILE_SIZE - 4, SB::Sokoban::TILE_SIZE - 4));
+    selection.setFillColor(sf::Color::Transparent);
+    selection.setOutlineColor(sf::Color::Yellow);
+    selection.setOutlineThickness(2);
 
     bool keyPressed = false;
     bool winMessage = false;
@@ -115,6 +224,7 @@ int main(int argc, char* argv[]) {
 
     const std::unordered_map<sf::Keyboard::Key, std::function<void()>> gameKeyStates {
         {sf::Keyboard::R, [&]() {
+            saveRecording();
             game.reset();
             moveCounterText.setString("Moves: 0");
             keyPressed = true;
@@ -130,109 +240,209 @@ int main(int argc, char* argv[]) {
             game.redo();
             moveCounterText.setString("Moves: " + std::to_string(game.getMoveCount()));
         }},
+        {sf::Keyboard::Home, [&]() {
+            game.jumpTo(game.board().firstMove());
+            moveCounterText.setString("Moves: " + std::to_string(game.getMoveCount()));
+        }},
+        {sf::Keyboard::End, [&]() {
+            game.jumpTo(game.board().lastMove());
+            moveCounterText.setString("Moves: " + std::to_string(game.getMoveCount()));
+        }},
         {sf::Keyboard::Escape, [&]() {
             window.close();
         }}
     };
 
-    std::vector<std::string> levels = {
-        "assets/sokoban/Levels/level1.lvl", "assets/sokoban/Levels/level2.lvl",
-        "assets/sokoban/Levels/level3.lvl", "assets/sokoban/Levels/level4.lvl",
-        "assets/sokoban/Levels/level5.lvl", "assets/sokoban/Levels/level6.lvl"
-    };
+    // The board only changes on input, so the loop sleeps in waitEvent until
+    // something happens. Frames are only drawn when the picture changes, and
+    // never faster than frameLimit while timers or loading assets need them.
+    window.setFramerateLimit(frameLimit);
+    bool redraw = true;
+    int shownCountdown = -1;
+    SB::FrameStats stats;
+    sf::Clock frameClock;
 
-    unsigned int level = 0;
+    // latency of each phase of the loop, shown by F3 and written by --profile
+    SB::Profiler profiler;
+    const size_t eventPhase = profiler.add("events");
+    const size_t movePhase = profiler.add("move");
+    const size_t wonPhase = profiler.add("isWon");
+    const size_t drawPhase = profiler.add("draw");
+    const size_t displayPhase = profiler.add("display");
 
-    while (window.isOpen()) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                window.close();
+    auto handleEvent = [&](const sf::Event& event) {
+        SB::Profiler::Scope scope(profiler, eventPhase);
+        SB::Trace::Scope traceScope("event");
+        if (event.type == sf::Event::Closed) {
+            window.close();
+        }
+        if (event.type == sf::Event::Resized || event.type == sf::Event::GainedFocus) {
+            redraw = true;
+        }
+        if (event.type == sf::Event::KeyPressed || event.type == sf::Event::MouseButtonPressed) {
+            redraw = true;
+        }
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+            showProfile = !showProfile;
+            return;
+        }
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::R) {
+            saveRecording();
+            game.reset();
+            moveCounterText.setString("Moves: 0");
+            keyPressed = true;
+            crateSelected = false;
+            winMessage = false;
+            nextLevelTimer = DELAY;
+            winSound.stop();
+            winClock.restart();
+            elapsedClock.restart();
+            return;
+        }
+        if (event.type == sf::Event::KeyReleased) {
+            keyPressed = false;
+        }
+
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape) {
+            window.close();
+        }
+
+        if (!game.isWon() && event.type == sf::Event::MouseButtonPressed) {
+            // a left click selects a crate or walks there, or pushes the selected
+            // crate there; a right click drops the selection
+            sf::Vector2f point = window.mapPixelToCoords({event.mouseButton.x, event.mouseButton.y});
+            if (event.mouseButton.button == sf::Mouse::Right || point.x < 0 || point.y < 0) {
+                crateSelected = false;
+                return;
             }
-            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::R) {
-                game.reset();
-                moveCounterText.setString("Moves: 0");
-                keyPressed = true;
-                winMessage = false;
-                nextLevelTimer = DELAY;
-                winSound.stop();
-                winClock.restart();
-                elapsedClock.restart();
-                continue;
+            SB::Position cell{static_cast<unsigned int>(point.x) / SB::Sokoban::TILE_SIZE,
+                              static_cast<unsigned int>(point.y) / SB::Sokoban::TILE_SIZE};
+            if (event.mouseButton.button != sf::Mouse::Left ||
+                cell.x >= game.width() || cell.y >= game.height()) {
+                return;
             }
-            if (event.type == sf::Event::KeyReleased) {
-                keyPressed = false;
+            SB::Profiler::Scope moveScope(profiler, movePhase);
+            if (SB::isCrate(game.board().at(cell.x, cell.y))) {
+                crateSelected = !(crateSelected && selectedCrate.x == cell.x && selectedCrate.y == cell.y);
+                selectedCrate = cell;
+                selection.setPosition(cell.x * SB::Sokoban::TILE_SIZE + 2, cell.y * SB::Sokoban::TILE_SIZE + 2);
+                return;
             }
-
-            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape) {
-                window.close();
+            if (crateSelected) {
+                crateSelected = !game.pushTo(selectedCrate, cell);
+            } else {
+                game.walkTo(cell);
             }
+            moveCounterText.setString("Moves: " + std::to_string(game.getMoveCount()));
+            return;
+        }
 
-            if (!game.isWon()) {
-                // get key pressed
-                if (event.type == sf::Event::KeyPressed) {
-                    auto itGame = gameKeyStates.find(event.key.code);
-                    auto itMovement = movementKeyStates.find(event.key.code);
-                    // if key is not in either map, continue
-                    if (itGame == gameKeyStates.end() &&
-                        itMovement == movementKeyStates.end()) {
-                        continue;
-                        // if key is in gameKeyStates, then access its value (function)
-                    } else if (itGame != gameKeyStates.end()) {
-                        itGame->second();
-                        continue;
-                        // if key is in movementKeyStates, then pass it to getMovementInput
-                    } else {
-                        getMovementInput(game, moveCounterText, window, keyPressed,
-                                 event.key.code, movementKeyStates);
-                    }
-                    std::cout << game;
-                }
-                // reset key pressed
-                if (event.type == sf::Event::KeyReleased) {
-                    keyPressed = false;
+        if (!game.isWon()) {
+            // get key pressed
+            if (event.type == sf::Event::KeyPressed) {
+                auto itGame = gameKeyStates.find(event.key.code);
+                auto itMovement = movementKeyStates.find(event.key.code);
+                // if key is not in either map, ignore it
+                if (itGame == gameKeyStates.end() &&
+                    itMovement == movementKeyStates.end()) {
+                    return;
+                    // if key is in gameKeyStates, then access its value (function)
+                } else if (itGame != gameKeyStates.end()) {
+                    itGame->second();
+                    return;
+                    // if key is in movementKeyStates, then pass it to getMovementInput
+                } else {
+                    SB::Profiler::Scope moveScope(profiler, movePhase);
+                    getMovementInput(game, moveCounterText, window, keyPressed,
+                             event.key.code, movementKeyStates);
                 }
-            } else if (!winMessage) {
-                // player won
-                timeToBeat = elapsedClock.getElapsedTime().asSeconds();
-                winMessage = true;
-                nextLevelTimer = DELAY;
-                winClock.restart();
-                winSound.play();
-
-                sf::FloatRect winTextBounds = winText.getLocalBounds();
-                winText.setOrigin(winTextBounds.width / 2, winTextBounds.height / 2);
-                winText.setPosition(window.getSize().x / 2, window.getSize().y / 2 - 30);
+                std::cout << game;
+            }
+        }
+    };
+
+    while (window.isOpen()) {
+        if (!font && SB::isReady(fontHandle)) {
+            font = fontHandle.get();
+            if (!font) {
+                throw std::runtime_error("Failed to load font");
+            }
+            for (sf::Text* text : {&moveCounterText, &profileText, &winText, &timerText,
+                                   &elapsedText}) {
+                text->setFont(*font);
+            }
+            redraw = true;
+        }
+        if (!winSoundBuffer && SB::isReady(winSoundHandle)) {
+            winSoundBuffer = winSoundHandle.get();
+            if (!winSoundBuffer) {
+                throw std::runtime_error("Failed to load win sound");
+            }
+            winSound.setBuffer(*winSoundBuffer);
+        }
+        redraw |= game.updateAssets();
+
+        bool ticking = winMessage || !font || !winSoundBuffer || !game.assetsLoaded();
+        sf::Event event;
+        if (!ticking && !redraw && window.waitEvent(event)) {
+            // nothing to animate, so block until the next input
+            handleEvent(event);
+        }
+        while (window.pollEvent(event)) {
+            handleEvent(event);
+        }
+        if (!window.isOpen()) {
+            break;
+        }
+
+        bool won;
+        {
+            SB::Profiler::Scope scope(profiler, wonPhase);
+            won = game.isWon();
+        }
+        if (won && !winMessage) {
+            // player won
+            saveRecording();
+            timeToBeat = elapsedClock.getElapsedTime().asSeconds();
+            winMessage = true;
+            nextLevelTimer = DELAY;
+            winClock.restart();
+            winSound.play();
+            shownCountdown = -1;
+            if (level + 1 < levelCount && !nextLevel.valid()) {
+                prepareLevel(level + 1);
             }
+
+            sf::FloatRect winTextBounds = winText.getLocalBounds();
+            winText.setOrigin(winTextBounds.width / 2, winTextBounds.height / 2);
+            winText.setPosition(window.getSize().x / 2, window.getSize().y / 2 - 30);
         }
 
-        if (game.isWon() && winMessage) {
+        if (won && winMessage) {
             float elapsed = winClock.getElapsedTime().asSeconds();
             nextLevelTimer -= elapsed;
             winClock.restart();
 
             if (nextLevelTimer <= 0) {
                 level++;
-                if (level < levels.size()) {
+                if (level < levelCount) {
                     elapsedClock.restart();
                     winSound.stop();
-                    level_file = levels[level];
-                    std::ifstream ifs(level_file, std::ifstream::in);
-                    if (!ifs.is_open()) {
-                        throw std::runtime_error("Failed to open " + level_file);
-                    }
-                    ifs >> game;
-
-                    // close and reopen with new level's dimensions
-                    window.close();
-                    window.create(sf::VideoMode(game.pixelWidth(),
-                                              game.pixelHeight()),
-                                              "Sokoban!",
-                                              sf::Style::Titlebar);
+
+                    // only waits if the loader is still busy with a large level
+                    SB::Trace::Scope scope("swap level", "load");
+                    game.load(nextLevel.get());
+                    // keep the window, fit it and its view to the new level
+                    sf::Vector2u size(game.pixelWidth(), game.pixelHeight());
+                    window.setSize(size);
+                    window.setView(sf::View(sf::FloatRect(0, 0, size.x, size.y)));
                     moveCounterText.setString("Moves: 0");
+                    crateSelected = false;
                     winMessage = false;
+                    redraw = true;
                 } else {
                     window.close();
+                    break;
                 }
             }
             elapsedText.setString("Time to beat: " +
@@ -241,24 +451,71 @@ int main(int argc, char* argv[]) {
             elapsedText.setOrigin(elapsedTextBounds.width / 2, elapsedTextBounds.height / 2);
             elapsedText.setPosition(window.getSize().x / 2, window.getSize().y / 2 + 30);
 
-            timerText.setString("Next level in: " +
-                std::to_string(static_cast<int>(nextLevelTimer) + 1) + "s");
+            // only redraw when the countdown shows a different number
+            int countdown = static_cast<int>(nextLevelTimer) + 1;
+            if (countdown != shownCountdown) {
+                shownCountdown = countdown;
+                redraw = true;
+            }
+            timerText.setString("Next level in: " + std::to_string(countdown) + "s");
             sf::FloatRect timerTextBounds = timerText.getLocalBounds();
             timerText.setOrigin(timerTextBounds.width / 2, timerTextBounds.height / 2);
             timerText.setPosition(window.getSize().x / 2, window.getSize().y / 2 + 90);
         }
 
-        window.clear();
-        window.draw(game);
-        window.draw(moveCounterText);
+        if (redraw) {
+            SB::Trace::Scope scope("frame");
+            frameClock.restart();
+            {
+                SB::Profiler::Scope scope(profiler, drawPhase);
+                window.clear();
+                window.draw(game);
+                if (crateSelected && !winMessage) {
+                    window.draw(selection);
+                }
+                window.draw(moveCounterText);
+                if (showProfile) {
+                    profileText.setString(profiler.overlay());
+                    window.draw(profileText);
+                }
+
+                // IF PLAYER WON
+                if (winMessage) {
+                    window.draw(winText);
+                    window.draw(elapsedText);
+                    window.draw(timerText);
+                }
+            }
+            stats.frame(frameClock.getElapsedTime().asSeconds());
+            {
+                // display() also waits out the rest of the frame when capped
+                SB::Profiler::Scope scope(profiler, displayPhase);
+                window.display();
+            }
+            redraw = false;
+        } else if (ticking) {
+            // nothing new to show, wait a frame before checking the timers again
+            sf::sleep(sf::seconds(1.0f / frameLimit));
+        }
 
-        // IF PLAYER WON
-        if (winMessage) {
-            window.draw(winText);
-            window.draw(elapsedText);
-            window.draw(timerText);
+        if (showStats && stats.due(5.0)) {
+            std::cerr << stats.report() << std::endl;
+        }
+    }
+    if (!game.isWon()) {
+        saveRecording();
+    }
+    if (showStats) {
+        std::cerr << stats.report() << std::endl;
+    }
+    trace.stop();
+    if (!profileFile.empty()) {
+        std::ofstream profileOut(profileFile);
+        if (!profileOut.is_open()) {
+            std::cerr << "Failed to open " << profileFile << std::endl;
+            return 1;
         }
-        window.display();
+        profiler.write(profileOut);
     }
     return 0;
 }
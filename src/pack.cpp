@@ -0,0 +1,47 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "sokoban/Batch.hpp"
+#include "sokoban/LevelPack.hpp"
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " levels.pack level_dir_or_file..." << std::endl;
+        std::cerr << "       " << argv[0] << " --list levels.pack" << std::endl;
+        return 1;
+    }
+
+    try {
+        if (std::string(argv[1]) == "--list") {
+            SB::LevelPack pack(argv[2]);
+            for (size_t i = 0; i < pack.size(); i++) {
+                SB::PackedLevel level = pack.level(i);
+                std::cout << i << "\t" << level.name << "\t" << level.width << "x" <<
+                             level.height << "\t" << level.crateCount << " crates" << std::endl;
+            }
+            return 0;
+        }
+
+        std::vector<SB::BatchLevel> levels;
+        for (int i = 2; i < argc; i++) {
+            for (SB::BatchLevel& level : SB::loadLevels(argv[i])) {
+                if (!level.error.empty()) {
+                    std::cerr << "skipping " << level.name << ": " << level.error << std::endl;
+                    continue;
+                }
+                levels.push_back(std::move(level));
+            }
+        }
+        SB::LevelPack::write(argv[1], levels);
+        std::cerr << "packed " << levels.size() << " levels into " << argv[1] << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "sokoban/Batch.hpp"
+#include "sokoban/Board.hpp"
+#include "sokoban/Solver.hpp"
+#include "sokoban/ThreadPool.hpp"
+#include "sokoban/Trace.hpp"
+
+namespace {
+// solves every level of a directory or a multi-level file and writes a report
+int solveAll(const std::string& path, const SB::SolverOptions& options, size_t threads,
+             const std::string& format, const std::string& output) {
+    std::vector<SB::BatchLevel> levels = SB::loadLevels(path);
+    SB::ThreadPool pool(threads);
+    std::vector<SB::BatchResult> results = SB::solveBatch(levels, options, pool);
+
+    std::ofstream ofs;
+    if (!output.empty()) {
+        ofs.open(output);
+        if (!ofs.is_open()) {
+            std::cerr << "Failed to open " << output << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = output.empty() ? std::cout : ofs;
+    if (format == "json") {
+        SB::writeJson(out, results);
+    } else {
+        SB::writeCsv(out, results);
+    }
+
+    size_t solved = 0;
+    for (const SB::BatchResult& result : results) {
+        solved += result.solution.solved() ? 1 : 0;
+    }
+    std::cerr << "solved " << solved << " of " << results.size() <<
+                 " levels on " << pool.size() << " threads" << std::endl;
+    return solved == results.size() ? 0 : 2;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " level_file.lvl" <<
+        " [--pushes] [--ida] [--weight w] [--nodes n] [--table n]" <<
+        " [--timeout seconds] [--memory MiB]" << std::endl;
+        std::cerr << "       " << argv[0] << " --batch level_dir_or_file" <<
+        " [--threads n] [--format csv|json] [--output report] [solver options]" << std::endl;
+        std::cerr << "       --trace trace.json records a Chrome trace of the solver runs" << std::endl;
+        return 1;
+    }
+
+    SB::SolverOptions options;
+    std::string level_file;
+    bool batch = false;
+    size_t threads = 0;
+    std::string format = "csv";
+    std::string output;
+    // a value that does not parse names its option instead of aborting
+    std::string arg;
+    try {
+        for (int i = 1; i < argc; i++) {
+            arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--pushes") {
+                options.objective = SB::SolverOptions::Objective::Pushes;
+            } else if (arg == "--ida") {
+                options.algorithm = SB::SolverOptions::Algorithm::IDAStar;
+            } else if (arg == "--weight" && hasValue) {
+                options.weight = std::stod(argv[++i]);
+            } else if (arg == "--nodes" && hasValue) {
+                options.maxNodes = std::stoull(argv[++i]);
+            } else if (arg == "--table" && hasValue) {
+                options.tableSize = std::stoull(argv[++i]);
+            } else if (arg == "--timeout" && hasValue) {
+                options.timeLimit = std::stod(argv[++i]);
+            } else if (arg == "--memory" && hasValue) {
+                options.maxMemory = std::stoull(argv[++i]) << 20;
+            } else if (arg == "--batch") {
+                batch = true;
+            } else if (arg == "--threads" && hasValue) {
+                threads = std::stoull(argv[++i]);
+            } else if (arg == "--format" && hasValue) {
+                format = argv[++i];
+            } else if (arg == "--output" && hasValue) {
+                output = argv[++i];
+            } else if (arg == "--trace" && hasValue) {
+                SB::Trace::instance().start(argv[++i]);
+                SB::Trace::instance().setThreadName("main");
+            } else {
+                level_file = arg;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid value for " << arg << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    // writes the trace on every way out of main, does nothing without --trace
+    struct TraceGuard {
+        ~TraceGuard() { SB::Trace::instance().stop(); }
+    } traceGuard;
+
+    if (batch) {
+        try {
+            return solveAll(level_file, options, threads, format, output);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    std::ifstream ifs(level_file, std::ifstream::in);
+    if (!ifs.is_open()) {
+        std::cerr << "Failed to open " << level_file << std::endl;
+        return 1;
+    }
+    SB::Solution solution;
+    try {
+        SB::Board board;
+        ifs >> board;
+        SB::Solver solver(board, options);
+        solution = solver.solve();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    switch (solution.status) {
+        case SB::Solution::Status::Solved:
+            std::cout << solution.moves << std::endl;
+            break;
+        default:
+            std::cout << SB::toString(solution.status) << std::endl;
+            break;
+    }
+    std::cerr << "moves: " << solution.moveCount <<
+                 " pushes: " << solution.pushCount <<
+                 " nodes: " << solution.nodesExpanded <<
+                 " optimal: " << (solution.optimal ? "yes" : "no") << std::endl;
+    return solution.solved() ? 0 : 2;
+}
@@ -0,0 +1,189 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "sokoban/Batch.hpp"
+#include "sokoban/BitBoard.hpp"
+#include "sokoban/Board.hpp"
+#include "sokoban/FixedBoard.hpp"
+#include "sokoban/LevelPack.hpp"
+#include "sokoban/Replay.hpp"
+#include "sokoban/ThreadPool.hpp"
+
+namespace {
+// records verified together, the next batch is read while these run
+const size_t BATCH_SIZE = 4096;
+// records per task, so the pool is not flooded with tiny tasks
+const size_t TASK_SIZE = 64;
+
+// replays a move string on a fresh copy of one level
+using Replayer = std::function<SB::ReplayResult(const std::string&)>;
+
+struct Record {
+    std::string level;
+    std::string moves;
+    const Replayer* replay{nullptr};  // null if the level is unknown
+    SB::ReplayResult result;
+};
+
+// the level id is everything before the first tab, or the first blank if there is no tab
+bool parseRecord(const std::string& line, Record* record) {
+    size_t split = line.find('\t');
+    if (split == std::string::npos) {
+        split = line.find(' ');
+    }
+    if (split == std::string::npos || split == 0) {
+        return false;
+    }
+    record->level = line.substr(0, split);
+    record->moves = line.substr(split + 1);
+    return true;
+}
+
+// reads at least one record, then whatever input is already waiting, up to a batch
+void readBatch(std::istream& in, const std::unordered_map<std::string, Replayer>& levels,
+               std::vector<Record>* batch) {
+    batch->clear();
+    std::string line;
+    while (batch->size() < BATCH_SIZE && std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        Record record;
+        if (!line.empty() && !parseRecord(line, &record)) {
+            record.level = line;
+        }
+        if (!line.empty()) {
+            auto it = levels.find(record.level);
+            record.replay = it == levels.end() ? nullptr : &it->second;
+            batch->push_back(std::move(record));
+        }
+        if (!batch->empty() && in.rdbuf()->in_avail() <= 0) {
+            break;
+        }
+    }
+}
+
+// keeps the level in the representation B, every record replays on its own copy
+template <typename B>
+Replayer replayer(B level) {
+    return [level](const std::string& moves) {
+        B board = level;
+        return SB::replay(&board, moves);
+    };
+}
+
+void submitBatch(std::vector<Record>* batch, SB::ThreadPool& pool) {
+    for (size_t first = 0; first < batch->size(); first += TASK_SIZE) {
+        size_t last = std::min(first + TASK_SIZE, batch->size());
+        pool.submit([batch, first, last] {
+            for (size_t i = first; i < last; i++) {
+                Record& record = (*batch)[i];
+                if (record.replay) {
+                    try {
+                        record.result = (*record.replay)(record.moves);
+                    } catch (const std::exception&) {
+                        // a level without a player cannot be played
+                        record.result.valid = false;
+                    }
+                }
+            }
+        });
+    }
+}
+
+void writeBatch(std::ostream& out, const std::vector<Record>& batch) {
+    for (const Record& record : batch) {
+        const SB::ReplayResult& result = record.result;
+        const char* verdict = !record.replay ? "unknown-level" :
+                              !result.valid ? "invalid" :
+                              result.won ? "solved" : "unsolved";
+        out << record.level << '\t' << verdict << '\t' <<
+               result.moves << '\t' << result.pushes << '\n';
+    }
+    out.flush();
+}
+
+void addLevels(const std::string& path, std::unordered_map<std::string, SB::Board>* levels) {
+    if (path.size() > 5 && path.compare(path.size() - 5, 5, ".pack") == 0) {
+        SB::LevelPack pack(path);
+        for (size_t i = 0; i < pack.size(); i++) {
+            levels->emplace(std::string(pack.level(i).name), pack.board(i));
+        }
+        return;
+    }
+    for (SB::BatchLevel& level : SB::loadLevels(path)) {
+        if (!level.error.empty()) {
+            std::cerr << "skipping " << level.name << ": " << level.error << std::endl;
+            continue;
+        }
+        levels->emplace(std::move(level.name), std::move(level.board));
+    }
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " level_dir_or_file... [--threads n] [--bitboard]" <<
+                     std::endl;
+        std::cerr << "Reads \"level<TAB>solution\" lines on stdin and writes" <<
+                     " \"level<TAB>result<TAB>moves<TAB>pushes\" lines in the same order" << std::endl;
+        return 1;
+    }
+
+    size_t threads = 0;
+    bool bitboard = false;
+    std::unordered_map<std::string, SB::Board> boards;
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--threads" && i + 1 < argc) {
+                threads = std::stoull(argv[++i]);
+            } else if (arg == "--bitboard") {
+                bitboard = true;
+            } else {
+                addLevels(arg, &boards);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    // the representation is picked once per level: the smallest fixed grid
+    // it fits, or the packed board with --bitboard
+    std::unordered_map<std::string, Replayer> levels;
+    for (const auto& entry : boards) {
+        levels.emplace(entry.first, bitboard ? replayer(SB::BitBoard(entry.second)) :
+                       SB::withFixedBoard(entry.second, [](const auto& board) {
+                           return replayer(board);
+                       }));
+    }
+    boards.clear();
+
+    std::ios::sync_with_stdio(false);
+    SB::ThreadPool pool(threads);
+    std::vector<Record> current, next;
+    readBatch(std::cin, levels, &current);
+    while (!current.empty()) {
+        submitBatch(&current, pool);
+        // read ahead while the pool works, but only what is already waiting
+        next.clear();
+        if (std::cin.rdbuf()->in_avail() > 0) {
+            readBatch(std::cin, levels, &next);
+        }
+        pool.wait();
+        writeBatch(std::cout, current);
+        if (next.empty()) {
+            readBatch(std::cin, levels, &next);
+        }
+        std::swap(current, next);
+    }
+    return 0;
+}
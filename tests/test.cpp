@@ -209,6 +209,32 @@ BOOST_AUTO_TEST_CASE(testUndoRedo) {
     BOOST_REQUIRE_EQUAL(game.playerLoc().y, initialPos.y - 1);
 }
 
+BOOST_AUTO_TEST_CASE(testJumpToEnds) {
+    std::stringstream ss;
+    ss << "3 5\n";
+    ss << ".....\n";
+    ss << "..@..\n";
+    ss << ".....\n";
+
+    SB::Sokoban game;
+    ss >> game;
+    // Home and End jump through the archive, not one step at a time
+    BOOST_REQUIRE(game.board().archive().enabled());
+
+    sf::Vector2u initialPos = game.playerLoc();
+    for (int i = 0; i < 1000; i++) {
+        game.movePlayer(i % 2 ? SB::Direction::Left : SB::Direction::Right);
+    }
+    game.movePlayer(SB::Direction::Up);
+    BOOST_REQUIRE(game.jumpTo(game.board().firstMove()));
+    BOOST_REQUIRE_EQUAL(game.board().getMoveCount(), 0);
+    BOOST_REQUIRE_EQUAL(game.playerLoc().y, initialPos.y);
+
+    BOOST_REQUIRE(game.jumpTo(game.board().lastMove()));
+    BOOST_REQUIRE_EQUAL(game.board().getMoveCount(), 1001);
+    BOOST_REQUIRE_EQUAL(game.playerLoc().y, initialPos.y - 1);
+}
+
 BOOST_AUTO_TEST_CASE(testMoveOff) {
     std::stringstream ss;
     ss << "6 5\n";
@@ -322,11 +348,50 @@ BOOST_AUTO_TEST_CASE(testBoardSymbols) {
     expected << "#######\n";
     expected << "#...1.#\n";
     expected << "#.1...#\n";
-    expected << "#....1#\n";
-    expected << "#.aa@A#\n";
-    expected << "#1....#\n";
+    // crates stuck against the walls are shown locked
+    expected << "#....l#\n";
+    expected << "#.aa@L#\n";
+    expected << "#l....#\n";
     expected << "#######\n";
 
     std::string expectedString = expected.str();
     BOOST_REQUIRE_EQUAL(actualString, expectedString);
 }
+
+BOOST_AUTO_TEST_CASE(testIndependentGames) {
+    std::stringstream first;
+    first << "5 5\n";
+    first << ".....\n";
+    first << ".....\n";
+    first << "..@Aa\n";
+    first << ".....\n";
+    first << ".....\n";
+
+    std::stringstream second;
+    second << "5 5\n";
+    second << "..a..\n";
+    second << "..A..\n";
+    second << ".....\n";
+    second << "..@..\n";
+    second << ".....\n";
+
+    SB::Sokoban gameA;
+    SB::Sokoban gameB;
+    first >> gameA;
+    second >> gameB;
+
+    // moving one game must not move the other
+    gameA.movePlayer(SB::Direction::Right);
+    BOOST_REQUIRE_EQUAL(gameA.isWon(), true);
+    BOOST_REQUIRE_EQUAL(gameB.isWon(), false);
+    BOOST_REQUIRE_EQUAL(gameB.playerLoc().x, 2);
+    BOOST_REQUIRE_EQUAL(gameB.playerLoc().y, 3);
+
+    gameB.movePlayer(SB::Direction::Up);
+    gameB.movePlayer(SB::Direction::Up);
+    BOOST_REQUIRE_EQUAL(gameB.isWon(), true);
+    BOOST_REQUIRE_EQUAL(gameA.playerLoc().x, 3);
+    BOOST_REQUIRE_EQUAL(gameA.playerLoc().y, 2);
+    BOOST_REQUIRE_EQUAL(gameA.getMoveCount(), 1);
+    BOOST_REQUIRE_EQUAL(gameB.getMoveCount(), 2);
+}
@@ -0,0 +1,881 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Board
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+#include "sokoban/AssetCache.hpp"
+#include "sokoban/BitBoard.hpp"
+#include "sokoban/FixedBoard.hpp"
+#include "sokoban/Board.hpp"
+#include "sokoban/FrameStats.hpp"
+#include "sokoban/Profiler.hpp"
+#include "sokoban/Replay.hpp"
+
+// counts every allocation of the test binary, see testMovesDoNotAllocate
+namespace {
+std::atomic<size_t> allocations{0};
+}  // namespace
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+
+BOOST_AUTO_TEST_CASE(testBoardIsOneBytePerCell) {
+    BOOST_REQUIRE_EQUAL(sizeof(SB::TileType), 1);
+}
+
+BOOST_AUTO_TEST_CASE(testBoardLevelLoading) {
+    std::stringstream ss;
+    ss << "5 6\n";
+    ss << "######\n";
+    ss << "#....#\n";
+    ss << "#.@Aa#\n";
+    ss << "#....#\n";
+    ss << "######\n";
+
+    SB::Board board;
+    ss >> board;
+
+    BOOST_REQUIRE_EQUAL(board.height(), 5);
+    BOOST_REQUIRE_EQUAL(board.width(), 6);
+    BOOST_REQUIRE_EQUAL(board.size(), 30);
+    BOOST_REQUIRE_EQUAL(board.playerLoc().x, 2);
+    BOOST_REQUIRE_EQUAL(board.playerLoc().y, 2);
+    BOOST_REQUIRE(board.at(3, 2) == SB::TileType::CRATES);
+    BOOST_REQUIRE(board.isStorageLocation({4, 2}));
+    BOOST_REQUIRE(!board.isStorageLocation({2, 2}));
+}
+
+BOOST_AUTO_TEST_CASE(testBoardPushAndWin) {
+    std::stringstream ss;
+    ss << "5 5\n";
+    ss << ".....\n";
+    ss << ".@...\n";
+    ss << "..A..\n";
+    ss << "..a..\n";
+    ss << ".....\n";
+
+    SB::Board board;
+    ss >> board;
+
+    BOOST_REQUIRE_EQUAL(board.isWon(), false);
+    BOOST_REQUIRE(board.movePlayer(SB::Direction::Right));
+    BOOST_REQUIRE(board.movePlayer(SB::Direction::Down));
+    BOOST_REQUIRE(board.at(2, 3) == SB::TileType::HOLE_CRATES);
+    BOOST_REQUIRE_EQUAL(board.getMoveCount(), 2);
+    BOOST_REQUIRE_EQUAL(board.isWon(), true);
+}
+
+BOOST_AUTO_TEST_CASE(testBoardBlockedMoveIsNotCounted) {
+    std::stringstream ss;
+    ss << "3 3\n";
+    ss << "###\n";
+    ss << "#@#\n";
+    ss << "###\n";
+
+    SB::Board board;
+    ss >> board;
+
+    BOOST_REQUIRE(!board.movePlayer(SB::Direction::Up));
+    BOOST_REQUIRE(!board.movePlayer(SB::Direction::Left));
+    BOOST_REQUIRE_EQUAL(board.getMoveCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testBoardUndoRedoReset) {
+    std::stringstream ss;
+    ss << "5 5\n";
+    ss << ".....\n";
+    ss << ".....\n";
+    ss << "..@Aa\n";
+    ss << ".....\n";
+    ss << ".....\n";
+
+    SB::Board board;
+    ss >> board;
+
+    board.movePlayer(SB::Direction::Right);
+    BOOST_REQUIRE_EQUAL(board.isWon(), true);
+    BOOST_REQUIRE(board.playerDirection() == SB::Direction::Right);
+
+    board.undo();
+    BOOST_REQUIRE_EQUAL(board.isWon(), false);
+    BOOST_REQUIRE_EQUAL(board.playerLoc().x, 2);
+    BOOST_REQUIRE_EQUAL(board.getMoveCount(), 0);
+
+    board.redo();
+    BOOST_REQUIRE_EQUAL(board.isWon(), true);
+    BOOST_REQUIRE_EQUAL(board.getMoveCount(), 1);
+
+    board.reset();
+    BOOST_REQUIRE_EQUAL(board.isWon(), false);
+    BOOST_REQUIRE_EQUAL(board.playerLoc().x, 2);
+    BOOST_REQUIRE(board.playerDirection() == SB::Direction::Down);
+}
+
+BOOST_AUTO_TEST_CASE(testBoardRoundTrip) {
+    std::string level =
+        "4 6\n"
+        "######\n"
+        "#@A.a#\n"
+        "#.1..#\n"
+        "######\n";
+    std::stringstream ss(level);
+
+    SB::Board board;
+    ss >> board;
+
+    std::stringstream out;
+    out << board;
+    BOOST_REQUIRE_EQUAL(out.str(), level);
+}
+
+BOOST_AUTO_TEST_CASE(testBoardUndoRestoresExactTiles) {
+    std::stringstream ss;
+    ss << "3 6\n";
+    ss << "######\n";
+    ss << "#@CAa#\n";
+    ss << "######\n";
+
+    SB::Board board;
+    ss >> board;
+
+    std::stringstream before;
+    before << board;
+
+    // walking over the coin replaces it, pushing the crate covers the outline
+    // and locks it against the wall
+    board.movePlayer(SB::Direction::Right);
+    board.movePlayer(SB::Direction::Right);
+    BOOST_REQUIRE(board.at(4, 1) == SB::TileType::LOCKED_HOLE_CRATES);
+    BOOST_REQUIRE(board.at(2, 1) == SB::TileType::GROUNDS);
+
+    board.undo();
+    board.undo();
+    std::stringstream after;
+    after << board;
+    BOOST_REQUIRE_EQUAL(after.str(), before.str());
+
+    board.redo();
+    board.redo();
+    BOOST_REQUIRE_EQUAL(board.isWon(), true);
+    BOOST_REQUIRE_EQUAL(board.history().undoCount(), 2);
+    BOOST_REQUIRE_EQUAL(board.history().redoCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testBoardNewMoveDropsRedo) {
+    std::stringstream ss;
+    ss << "3 5\n";
+    ss << ".....\n";
+    ss << "..@..\n";
+    ss << ".....\n";
+
+    SB::Board board;
+    ss >> board;
+
+    board.movePlayer(SB::Direction::Left);
+    board.undo();
+    BOOST_REQUIRE_EQUAL(board.history().redoCount(), 1);
+    board.movePlayer(SB::Direction::Right);
+    BOOST_REQUIRE_EQUAL(board.history().redoCount(), 0);
+    board.redo();
+    BOOST_REQUIRE_EQUAL(board.playerLoc().x, 3);
+    BOOST_REQUIRE_EQUAL(board.getMoveCount(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(testBoardHistoryIsBounded) {
+    std::stringstream ss;
+    ss << "3 4\n";
+    ss << "....\n";
+    ss << ".@..\n";
+    ss << "....\n";
+
+    SB::Board board;
+    ss >> board;
+    board.setHistoryLimit(8);
+
+    for (int i = 0; i < 1000; i++) {
+        board.movePlayer(i % 2 ? SB::Direction::Left : SB::Direction::Right);
+    }
+    BOOST_REQUIRE_EQUAL(board.getMoveCount(), 1000);
+    BOOST_REQUIRE_EQUAL(board.history().undoCount(), 8);
+
+    for (int i = 0; i < 20; i++) {
+        board.undo();
+    }
+    BOOST_REQUIRE_EQUAL(board.getMoveCount(), 992);
+    BOOST_REQUIRE_EQUAL(board.playerLoc().x, 1);
+    for (int i = 0; i < 20; i++) {
+        board.redo();
+    }
+    BOOST_REQUIRE_EQUAL(board.getMoveCount(), 1000);
+}
+
+BOOST_AUTO_TEST_CASE(testBoardMatchedCountFollowsPushes) {
+    std::stringstream ss;
+    ss << "3 7\n";
+    ss << "#######\n";
+    ss << "#@1.aA#\n";
+    ss << "#######\n";
+
+    SB::Board board;
+    ss >> board;
+
+    BOOST_REQUIRE_EQUAL(board.boxCount(), 2);
+    BOOST_REQUIRE_EQUAL(board.storageCount(), 2);
+    BOOST_REQUIRE_EQUAL(board.matchedCount(), 1);
+    BOOST_REQUIRE_EQUAL(board.playerIndex(), 8);
+
+    // push the crate off its storage location, then onto the other one
+    board.movePlayer(SB::Direction::Right);
+    BOOST_REQUIRE_EQUAL(board.matchedCount(), 0);
+    BOOST_REQUIRE(board.at(2, 1) == SB::TileType::PLAYER);
+    board.movePlayer(SB::Direction::Right);
+    BOOST_REQUIRE_EQUAL(board.matchedCount(), 1);
+    BOOST_REQUIRE(board.at(4, 1) == SB::TileType::LOCKED_HOLE_CRATES);
+    BOOST_REQUIRE_EQUAL(board.isWon(), false);
+
+    board.undo();
+    board.undo();
+    BOOST_REQUIRE_EQUAL(board.matchedCount(), 1);
+    BOOST_REQUIRE(board.at(2, 1) == SB::TileType::HOLE_CRATES);
+    BOOST_REQUIRE_EQUAL(board.playerIndex(), 8);
+
+    board.redo();
+    board.reset();
+    BOOST_REQUIRE_EQUAL(board.matchedCount(), 1);
+    BOOST_REQUIRE_EQUAL(board.playerLoc().x, 1);
+}
+
+BOOST_AUTO_TEST_CASE(testBoardLocksDeadCrates) {
+    std::stringstream ss;
+    ss << "6 6\n";
+    ss << "######\n";
+    ss << "#....#\n";
+    ss << "#.A..#\n";
+    ss << "#.@.a#\n";
+    ss << "#....#\n";
+    ss << "######\n";
+
+    SB::Board board;
+    ss >> board;
+
+    const SB::LevelAnalysis& analysis = board.analysis();
+    BOOST_REQUIRE(analysis.isDeadSquare(1 * 6 + 1));
+    BOOST_REQUIRE(analysis.isDeadSquare(1 * 6 + 3));
+    BOOST_REQUIRE(!analysis.isDeadSquare(2 * 6 + 4));
+    BOOST_REQUIRE_EQUAL(analysis.pushDistance(3 * 6 + 4), 0);
+    BOOST_REQUIRE_EQUAL(analysis.pushDistance(3 * 6 + 2), 2);
+    BOOST_REQUIRE(board.at(2, 2) == SB::TileType::CRATES);
+
+    // against the top wall the crate can never reach the goal
+    BOOST_REQUIRE(board.movePlayer(SB::Direction::Up));
+    BOOST_REQUIRE(board.at(2, 1) == SB::TileType::LOCKED_CRATE);
+    board.undo();
+    BOOST_REQUIRE(board.at(2, 2) == SB::TileType::CRATES);
+    board.redo();
+    BOOST_REQUIRE(board.at(2, 1) == SB::TileType::LOCKED_CRATE);
+
+    // a locked crate can still slide along the wall
+    BOOST_REQUIRE(board.movePlayer(SB::Direction::Left));
+    BOOST_REQUIRE(board.movePlayer(SB::Direction::Up));
+    BOOST_REQUIRE(board.movePlayer(SB::Direction::Right));
+    BOOST_REQUIRE(board.at(3, 1) == SB::TileType::LOCKED_CRATE);
+}
+
+BOOST_AUTO_TEST_CASE(testBoardRelocksLikeAFreshLoad) {
+    std::stringstream ss;
+    ss << "8 10\n";
+    ss << "##########\n";
+    ss << "#@.#.AAAA#\n";
+    ss << "#.A..aAAA#\n";
+    ss << "#AAAaAAa##\n";
+    ss << "#Aa#A.#.a#\n";
+    ss << "#1A1AAaAA#\n";
+    ss << "#a.aAAa..#\n";
+    ss << "##########\n";
+
+    SB::Board board;
+    ss >> board;
+    // only the crates near a push are looked at again, the tiles must still
+    // match a board that checks every crate
+    std::vector<SB::TileType> cells(board.size());
+    uint32_t seed = 7;
+    for (int i = 0; i < 500; i++) {
+        seed = seed * 1103515245 + 12345;
+        int action = seed >> 16 & 7;
+        if (action == 6) {
+            board.undo();
+        } else if (action == 7) {
+            board.redo();
+        } else {
+            board.movePlayer(static_cast<SB::Direction>(action & 3));
+        }
+        for (size_t cell = 0; cell < board.size(); cell++) {
+            cells[cell] = board[cell];
+        }
+        SB::Board fresh(board.width(), board.height(), cells.data(),
+                        board.isStorageLocation(board.playerIndex()));
+        for (size_t cell = 0; cell < board.size(); cell++) {
+            BOOST_REQUIRE(board[cell] == fresh[cell]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testBoardReportsChangedCells) {
+    std::stringstream ss;
+    ss << "3 6\n";
+    ss << "######\n";
+    ss << "#@A.a#\n";
+    ss << "######\n";
+
+    SB::Board board;
+    ss >> board;
+    BOOST_REQUIRE(board.changedCells().empty());
+
+    auto changed = [&board]() {
+        std::vector<size_t> cells = board.changedCells();
+        std::sort(cells.begin(), cells.end());
+        cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+        return cells;
+    };
+    board.movePlayer(SB::Direction::Right);
+    BOOST_REQUIRE(changed() == std::vector<size_t>({7, 8, 9}));
+    board.undo();
+    BOOST_REQUIRE(changed() == std::vector<size_t>({7, 8, 9}));
+    BOOST_REQUIRE(!board.movePlayer(SB::Direction::Left));
+    BOOST_REQUIRE(board.changedCells().empty());
+}
+
+BOOST_AUTO_TEST_CASE(testReplayLurd) {
+    std::stringstream ss;
+    ss << "4 6\n";
+    ss << "######\n";
+    ss << "#@A.a#\n";
+    ss << "#....#\n";
+    ss << "######\n";
+
+    SB::Board level;
+    ss >> level;
+
+    SB::Board board = level;
+    SB::ReplayResult result = SB::replay(&board, "Rdrru L\nrR");
+    BOOST_REQUIRE_EQUAL(result.applied, 7);  // the wall stops the last push
+    BOOST_REQUIRE(!result.valid);
+    BOOST_REQUIRE_EQUAL(result.pushes, 2);
+
+    board = level;
+    result = SB::replay(&board, "RR");
+    BOOST_REQUIRE(result.solved());
+    BOOST_REQUIRE_EQUAL(result.moves, 2);
+    BOOST_REQUIRE_EQUAL(result.pushes, 2);
+    BOOST_REQUIRE_EQUAL(board.getPushCount(), 2);
+
+    // lowercase pushes and walking into walls are rejected
+    board = level;
+    BOOST_REQUIRE(!SB::replay(&board, "rR").valid);
+    board = level;
+    result = SB::replay(&board, "uRR");
+    BOOST_REQUIRE(!result.valid);
+    BOOST_REQUIRE_EQUAL(result.applied, 0);
+}
+
+BOOST_AUTO_TEST_CASE(testMoveRecorder) {
+    SB::MoveRecorder recorder;
+    recorder.record(SB::Direction::Right, true);
+    recorder.record(SB::Direction::Down, false);
+    recorder.undo();
+    BOOST_REQUIRE_EQUAL(recorder.moves(), "R");
+    recorder.redo();
+    BOOST_REQUIRE_EQUAL(recorder.moves(), "Rd");
+    recorder.undo();
+    recorder.record(SB::Direction::Left, false);
+    BOOST_REQUIRE_EQUAL(recorder.moves(), "Rl");
+
+    std::vector<unsigned long> times = recorder.times();
+    BOOST_REQUIRE_EQUAL(times.size(), 2);
+    BOOST_REQUIRE(times[0] <= times[1]);
+    std::ostringstream out;
+    out << recorder;
+    BOOST_REQUIRE_EQUAL(out.str().substr(0, 3), "Rl\t");
+}
+
+BOOST_AUTO_TEST_CASE(testBoardWalkTo) {
+    std::stringstream ss;
+    ss << "5 7\n";
+    ss << "#######\n";
+    ss << "#@.A..#\n";
+    ss << "#.#...#\n";
+    ss << "#....a#\n";
+    ss << "#######\n";
+
+    SB::Board board;
+    ss >> board;
+
+    std::string moves;
+    BOOST_REQUIRE(board.canReach({4, 1}));
+    BOOST_REQUIRE(!board.canReach({3, 1}));
+    BOOST_REQUIRE(board.walkTo({4, 1}, &moves));
+    BOOST_REQUIRE_EQUAL(moves.size(), 7);  // around the crate
+    BOOST_REQUIRE_EQUAL(board.getMoveCount(), 7);
+    BOOST_REQUIRE_EQUAL(board.getPushCount(), 0);
+    BOOST_REQUIRE_EQUAL(board.playerIndex(), 11);
+
+    // the whole walk is one undo
+    board.undo();
+    BOOST_REQUIRE_EQUAL(board.getMoveCount(), 0);
+    BOOST_REQUIRE_EQUAL(board.playerIndex(), 8);
+    board.redo();
+    BOOST_REQUIRE_EQUAL(board.getMoveCount(), 7);
+    BOOST_REQUIRE_EQUAL(board.playerIndex(), 11);
+
+    BOOST_REQUIRE(!board.walkTo({2, 2}));
+    BOOST_REQUIRE(!board.walkTo({3, 1}));
+    BOOST_REQUIRE_EQUAL(board.getMoveCount(), 7);
+
+    // the crate cannot leave the top row, and a push opens its cell
+    BOOST_REQUIRE(!board.pushTo({3, 1}, {5, 3}));
+    BOOST_REQUIRE(board.pushTo({3, 1}, {2, 1}));
+    BOOST_REQUIRE(board.canReach({3, 1}));
+    board.undo();
+    BOOST_REQUIRE(!board.canReach({3, 1}));
+    BOOST_REQUIRE_EQUAL(board.getMoveCount(), 7);
+}
+
+BOOST_AUTO_TEST_CASE(testBoardPushTo) {
+    std::stringstream ss;
+    ss << "5 7\n";
+    ss << "#######\n";
+    ss << "#@....#\n";
+    ss << "#.#A..#\n";
+    ss << "#....a#\n";
+    ss << "#######\n";
+
+    SB::Board level;
+    ss >> level;
+
+    SB::Board board = level;
+    std::string moves;
+    BOOST_REQUIRE(!board.pushTo({2, 2}, {5, 3}));
+    BOOST_REQUIRE(!board.pushTo({3, 2}, {2, 2}));
+    BOOST_REQUIRE(board.pushTo({3, 2}, {5, 3}, &moves));
+    BOOST_REQUIRE(board.isWon());
+    // down, then right twice after walking around the crate
+    BOOST_REQUIRE_EQUAL(board.getPushCount(), 3);
+    BOOST_REQUIRE_EQUAL(board.getMoveCount(), moves.size());
+
+    SB::Board replayed = level;
+    BOOST_REQUIRE(SB::replay(&replayed, moves).solved());
+
+    board.undo();
+    BOOST_REQUIRE_EQUAL(board.getMoveCount(), 0);
+    BOOST_REQUIRE_EQUAL(board.getPushCount(), 0);
+    BOOST_REQUIRE(SB::isCrate(board[17]));
+}
+
+namespace {
+// wider than a word and more than two words, so rows and blocks straddle them
+const char* const WIDE_LEVEL =
+    "9 15\n"
+    "###############\n"
+    "#@............#\n"
+    "#..A....A.....#\n"
+    "#......###....#\n"
+    "#.a.......A...#\n"
+    "#.....a.......#\n"
+    "#..........a..#\n"
+    "#.............#\n"
+    "###############\n";
+
+// plays a fixed pseudo-random walk on both boards, comparing them after every
+// move, undo and redo
+template <typename B>
+void requireSameGame(SB::Board* board, B* other) {
+    uint32_t seed = 12345;
+    for (int i = 0; i < 2000; i++) {
+        seed = seed * 1103515245 + 12345;
+        int action = seed >> 16 & 7;
+        if (action == 6) {
+            board->undo();
+            other->undo();
+        } else if (action == 7) {
+            board->redo();
+            other->redo();
+        } else {
+            SB::Direction dir = static_cast<SB::Direction>(action & 3);
+            BOOST_REQUIRE_EQUAL(board->movePlayer(dir), other->movePlayer(dir));
+        }
+        BOOST_REQUIRE_EQUAL(board->playerIndex(), other->playerIndex());
+        BOOST_REQUIRE_EQUAL(board->getMoveCount(), other->getMoveCount());
+        BOOST_REQUIRE_EQUAL(board->getPushCount(), other->getPushCount());
+        BOOST_REQUIRE_EQUAL(board->isWon(), other->isWon());
+        for (size_t cell = 0; cell < board->size(); cell++) {
+            BOOST_REQUIRE_EQUAL(SB::isCrate((*board)[cell]), other->isCrate(cell));
+        }
+    }
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(testBitBoardMatchesBoard) {
+    std::stringstream ss(WIDE_LEVEL);
+    SB::Board board;
+    ss >> board;
+    SB::BitBoard bits(board);
+    requireSameGame(&board, &bits);
+
+    for (unsigned int y = 0; y < board.height(); y++) {
+        for (unsigned int x = 0; x < board.width(); x++) {
+            BOOST_REQUIRE_EQUAL(board.canReach({x, y}), bits.canReach({x, y}));
+        }
+    }
+
+    bits.reset();
+    BOOST_REQUIRE(!bits.isDeadlocked());
+    BOOST_REQUIRE(SB::replay(&bits, "drRR").valid);
+    BOOST_REQUIRE_EQUAL(bits.getPushCount(), 2);
+    BOOST_REQUIRE(bits[2 * 15 + 5] == SB::TileType::CRATES);
+    BOOST_REQUIRE(!bits.isWon());
+}
+
+BOOST_AUTO_TEST_CASE(testFixedBoardMatchesBoard) {
+    std::stringstream ss(WIDE_LEVEL);
+    SB::Board board;
+    ss >> board;
+
+    // 15 columns need the spare one of a 16 wide grid
+    using Grid = SB::FixedBoard<16, 16>;
+    using Narrow = SB::FixedBoard<15, 15>;
+    BOOST_REQUIRE(Grid::fits(board));
+    BOOST_REQUIRE(!Narrow::fits(board));
+    BOOST_REQUIRE_THROW(Narrow{board}, std::runtime_error);
+    unsigned int width = SB::withFixedBoard(board, [](const auto& fixed) {
+        return sizeof(fixed) < 1024 ? fixed.width() : 0;
+    });
+    BOOST_REQUIRE_EQUAL(width, 15);
+
+    SB::FixedBoard<16, 16> fixed(board);
+    requireSameGame(&board, &fixed);
+    fixed.reset();
+    BOOST_REQUIRE(SB::replay(&fixed, "drRR").valid);
+    BOOST_REQUIRE(fixed.isCrate(2 * 15 + 5));
+
+    // the level's edge is not walled, stepping off it must fail on every side
+    std::stringstream open("2 2\n@.\n.A\n");
+    SB::Board small;
+    open >> small;
+    SB::FixedBoard<4, 2> tight(small);
+    BOOST_REQUIRE(!tight.movePlayer(SB::Direction::Up));
+    BOOST_REQUIRE(!tight.movePlayer(SB::Direction::Left));
+    BOOST_REQUIRE(tight.movePlayer(SB::Direction::Right));
+    BOOST_REQUIRE(!tight.movePlayer(SB::Direction::Right));
+    BOOST_REQUIRE(!tight.movePlayer(SB::Direction::Down));
+    BOOST_REQUIRE_EQUAL(tight.getMoveCount(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(testBitBoardDeadlocks) {
+    std::stringstream ss;
+    ss << "7 7\n";
+    ss << "#######\n";
+    ss << "#.....#\n";
+    ss << "#.##..#\n";
+    ss << "#.....#\n";
+    ss << "#.AA..#\n";
+    ss << "#.aa.@#\n";
+    ss << "#######\n";
+
+    SB::Board board;
+    ss >> board;
+    SB::BitBoard bits(board);
+    BOOST_REQUIRE(!bits.isDeadlocked());
+
+    BOOST_REQUIRE(SB::replay(&bits, "llU").valid);
+    BOOST_REQUIRE(!bits.isDeadlocked());
+    BOOST_REQUIRE(!bits.canReach({3, 3}));
+    bits.undo();
+    BOOST_REQUIRE(bits.canReach({3, 3}));
+    bits.redo();
+
+    // both crates under the wall make a 2x2 block with it
+    BOOST_REQUIRE(SB::replay(&bits, "dlU").valid);
+    BOOST_REQUIRE(bits.isDeadlocked());
+    bits.undo();
+    BOOST_REQUIRE(!bits.isDeadlocked());
+
+    // a crate against the left wall can never reach a goal
+    bits.reset();
+    BOOST_REQUIRE(SB::replay(&bits, "llUL").valid);
+    BOOST_REQUIRE(bits.isDeadlocked());
+}
+
+BOOST_AUTO_TEST_CASE(testBoardJumpsThroughLongHistory) {
+    std::stringstream ss(WIDE_LEVEL);
+    SB::Board board;
+    ss >> board;
+    const SB::Board start = board;
+    const size_t budget = 16 * 1024;
+    board.setHistoryLimit(100);
+    board.setHistoryBudget(budget);
+
+    std::vector<SB::Direction> moves;
+    uint32_t seed = 99;
+    while (moves.size() < 200000) {
+        seed = seed * 1103515245 + 12345;
+        SB::Direction dir = static_cast<SB::Direction>(seed >> 16 & 3);
+        if (board.movePlayer(dir)) {
+            moves.push_back(dir);
+        }
+    }
+    BOOST_REQUIRE_LE(board.archive().memoryUsage(), budget);
+    // the oldest moves no longer fit the budget
+    const size_t first = board.firstMove();
+    BOOST_REQUIRE_GT(first, 0);
+    BOOST_REQUIRE_EQUAL(board.lastMove(), moves.size());
+    BOOST_REQUIRE(!board.jumpTo(first - 1));
+
+    auto requireAt = [&](size_t move) {
+        SB::Board expected = start;
+        for (size_t i = 0; i < move; i++) {
+            expected.movePlayer(moves[i]);
+        }
+        BOOST_REQUIRE_EQUAL(board.getMoveCount(), move);
+        BOOST_REQUIRE_EQUAL(board.getPushCount(), expected.getPushCount());
+        BOOST_REQUIRE_EQUAL(board.matchedCount(), expected.matchedCount());
+        for (size_t cell = 0; cell < board.size(); cell++) {
+            BOOST_REQUIRE(board[cell] == expected[cell]);
+        }
+    };
+    for (size_t move : {first, moves.size() - 1, first + 5000, first + 4097, moves.size() - 50}) {
+        BOOST_REQUIRE(board.jumpTo(move));
+        requireAt(move);
+    }
+
+    // undo keeps going once the journal runs out, redo comes back
+    for (int i = 0; i < 300; i++) {
+        board.undo();
+    }
+    requireAt(moves.size() - 350);
+    for (int i = 0; i < 350; i++) {
+        board.redo();
+    }
+    requireAt(moves.size());
+
+    // a new move after a jump replaces the moves after it
+    board.jumpTo(first + 10);
+    board.movePlayer(moves[first + 10]);
+    BOOST_REQUIRE_EQUAL(board.lastMove(), first + 11);
+    requireAt(first + 11);
+}
+
+BOOST_AUTO_TEST_CASE(testMovesDoNotAllocate) {
+    std::stringstream ss;
+    ss << "4 7\n";
+    ss << "#######\n";
+    ss << "#.@A..#\n";
+    ss << "#...a.#\n";
+    ss << "#######\n";
+
+    SB::Board board;
+    ss >> board;
+    SB::FixedBoard<16, 16> fixed(board);
+    SB::MoveRecorder recorder;
+    // pushes the crate right and back, then returns to the start
+    const std::string lap = "RdrruLdllu";
+    BOOST_REQUIRE(SB::replay(&board, lap).valid);
+    BOOST_REQUIRE_EQUAL(board.getPushCount(), 2);
+
+    std::vector<SB::Direction> dirs;
+    for (char c : lap) {
+        SB::Direction dir;
+        SB::fromLurd(c, &dir);
+        dirs.push_back(dir);
+    }
+    auto play = [&](size_t laps) {
+        for (size_t i = 0; i < laps; i++) {
+            for (size_t j = 0; j < dirs.size(); j++) {
+                board.movePlayer(dirs[j]);
+                fixed.movePlayer(dirs[j]);
+                recorder.record(dirs[j], lap[j] < 'a');
+            }
+        }
+        for (size_t i = 0; i < 50; i++) {
+            board.undo();
+            fixed.undo();
+            recorder.undo();
+        }
+        for (size_t i = 0; i < 50; i++) {
+            board.redo();
+            fixed.redo();
+            recorder.redo();
+        }
+    };
+    // the first moves reserve the histories at their default limits, after
+    // that many more moves than a small reserve would hold cost nothing
+    play(1);
+    recorder.restart();
+
+    size_t before = allocations;
+    play(1000);
+    size_t after = allocations;
+    BOOST_REQUIRE_EQUAL(after - before, 0);
+    BOOST_REQUIRE_EQUAL(fixed.playerIndex(), board.playerIndex());
+}
+
+BOOST_AUTO_TEST_CASE(testBoardWithoutPlayer) {
+    std::stringstream ss;
+    ss << "2 2\n";
+    ss << "..\n";
+    ss << "..\n";
+
+    SB::Board board;
+    ss >> board;
+
+    BOOST_REQUIRE_THROW(board.playerLoc(), std::runtime_error);
+    BOOST_REQUIRE_THROW(board.movePlayer(SB::Direction::Up), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(testBoardsRunConcurrently) {
+    const std::string level =
+        "7 7\n"
+        "#######\n"
+        "#...a.#\n"
+        "#.aAA.#\n"
+        "#..@Aa#\n"
+        "#.aaaA#\n"
+        "#1....#\n"
+        "#######\n";
+    const unsigned int boardCount = 8;
+    const unsigned int moveCount = 20000;
+
+    // every board gets its own pseudo random walk, with some undo and redo
+    auto play = [&](unsigned int id) {
+        SB::Board board;
+        std::stringstream ss(level);
+        ss >> board;
+        unsigned int state = id * 2654435761u + 1;
+        for (unsigned int i = 0; i < moveCount; i++) {
+            state = state * 1103515245u + 12345u;
+            unsigned int r = (state >> 16) % 10;
+            if (r < 4) {
+                board.movePlayer(static_cast<SB::Direction>(r));
+            } else if (r < 6) {
+                board.undo();
+            } else if (r < 7) {
+                board.redo();
+            } else {
+                board.movePlayer(static_cast<SB::Direction>(r - 6));
+            }
+        }
+        std::stringstream out;
+        out << board << board.getMoveCount() << " " << board.isWon();
+        return out.str();
+    };
+
+    std::vector<std::string> sequential(boardCount);
+    for (unsigned int id = 0; id < boardCount; id++) {
+        sequential[id] = play(id);
+    }
+
+    std::vector<std::string> concurrent(boardCount);
+    std::vector<std::thread> threads;
+    for (unsigned int id = 0; id < boardCount; id++) {
+        threads.emplace_back([&, id]() { concurrent[id] = play(id); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (unsigned int id = 0; id < boardCount; id++) {
+        BOOST_REQUIRE_EQUAL(concurrent[id], sequential[id]);
+    }
+}
+
+namespace {
+// counts how often files are read, stands in for sf::Image
+struct CountedAsset {
+    static std::atomic<int> loads;
+    std::string name;
+
+    bool loadFromFile(const std::string& filename) {
+        loads++;
+        name = filename;
+        return filename.find("missing") == std::string::npos;
+    }
+};
+std::atomic<int> CountedAsset::loads{0};
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(testAssetCacheLoadsOnce) {
+    SB::AssetCache& cache = SB::AssetCache::instance();
+    auto first = cache.load<CountedAsset>("assets/a.png");
+    auto second = cache.load<CountedAsset>("assets/a.png");
+    BOOST_REQUIRE(first.get());
+    BOOST_REQUIRE_EQUAL(first.get()->name, "assets/a.png");
+    BOOST_REQUIRE_EQUAL(first.get().get(), second.get().get());
+    BOOST_REQUIRE_EQUAL(CountedAsset::loads, 1);
+
+    // a missing file is also looked for in the working directory, then left null
+    auto missing = cache.load<CountedAsset>("assets/missing.png");
+    BOOST_REQUIRE(!missing.get());
+    BOOST_REQUIRE_EQUAL(CountedAsset::loads, 3);
+    BOOST_REQUIRE(SB::isReady(missing));
+}
+
+BOOST_AUTO_TEST_CASE(testFrameStatsReport) {
+    SB::FrameStats stats;
+    stats.frame(0.002);
+    stats.frame(0.004);
+    BOOST_REQUIRE_EQUAL(stats.frames(), 2);
+
+    std::string report = stats.report();
+    BOOST_REQUIRE(report.find("frames: 2") != std::string::npos);
+    BOOST_REQUIRE(report.find("avg 3.00 ms, max 4.00 ms") != std::string::npos);
+    BOOST_REQUIRE(report.find("cpu: ") != std::string::npos);
+    // a report starts a new window
+    BOOST_REQUIRE_EQUAL(stats.frames(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testProfilerHistogram) {
+    SB::Profiler profiler;
+    size_t draw = profiler.add("draw");
+    for (int i = 0; i < 99; i++) {
+        profiler.record(draw, 0.0000005);  // under 1 us
+    }
+    profiler.record(draw, 0.003);  // 2048-4096 us
+
+    const SB::Profiler::Phase& phase = profiler.phase(draw);
+    BOOST_REQUIRE_EQUAL(phase.count, 100);
+    BOOST_REQUIRE_EQUAL(phase.buckets[0], 99);
+    BOOST_REQUIRE_EQUAL(phase.buckets[12], 1);
+    BOOST_REQUIRE_CLOSE(phase.percentile(0.5), 1e-6, 1e-6);
+    BOOST_REQUIRE_CLOSE(phase.percentile(0.999), 0.003, 1e-6);
+
+    std::ostringstream out;
+    profiler.write(out);
+    BOOST_REQUIRE(out.str().find("draw,100,") != std::string::npos);
+    BOOST_REQUIRE(out.str().find("draw,4096,1") != std::string::npos);
+
+    // a disabled profiler records nothing
+    profiler.clear();
+    profiler.setEnabled(false);
+    { SB::Profiler::Scope scope(profiler, draw); }
+    BOOST_REQUIRE_EQUAL(profiler.phase(draw).count, 0);
+    profiler.setEnabled(true);
+    { SB::Profiler::Scope scope(profiler, draw); }
+    BOOST_REQUIRE_EQUAL(profiler.phase(draw).count, 1);
+}
@@ -0,0 +1,424 @@
+// Copyright 2025
+// By Nguyen Mai
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Solver
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <boost/test/unit_test.hpp>
+
+#include "sokoban/Batch.hpp"
+#include "sokoban/Board.hpp"
+#include "sokoban/Generator.hpp"
+#include "sokoban/LevelPack.hpp"
+#include "sokoban/Solver.hpp"
+#include "sokoban/ThreadPool.hpp"
+#include "sokoban/Trace.hpp"
+#include "sokoban/XsbReader.hpp"
+
+namespace {
+SB::Board loadLevel(const std::string& filename) {
+    std::ifstream ifs(filename, std::ifstream::in);
+    if (!ifs.is_open()) {
+        throw std::runtime_error("Failed to open " + filename);
+    }
+    SB::Board board;
+    ifs >> board;
+    return board;
+}
+
+// plays a LURD string on the board and returns true if every letter was a
+// legal move, crates were pushed exactly on the uppercase letters and the
+// level ends up won
+bool replays(SB::Board board, const std::string& moves) {
+    for (char c : moves) {
+        SB::Direction dir;
+        if (!SB::fromLurd(c, &dir)) {
+            return false;
+        }
+        SB::Position next = board.playerLoc();
+        switch (dir) {
+            case SB::Direction::Up:    next.y--; break;
+            case SB::Direction::Down:  next.y++; break;
+            case SB::Direction::Left:  next.x--; break;
+            case SB::Direction::Right: next.x++; break;
+        }
+        SB::TileType type = board.at(next.x, next.y);
+        bool push = type == SB::TileType::CRATES || type == SB::TileType::HOLE_CRATES;
+        if (push != (c >= 'A' && c <= 'Z') || !board.movePlayer(dir)) {
+            return false;
+        }
+    }
+    return board.isWon();
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(testSolveSinglePush) {
+    SB::Board board = loadLevel("assets/sokoban/Levels/pushright.lvl");
+    SB::Solution solution = SB::Solver(board).solve();
+
+    BOOST_REQUIRE(solution.solved());
+    BOOST_REQUIRE_EQUAL(solution.moves, "R");
+    BOOST_REQUIRE_EQUAL(solution.moveCount, 1);
+    BOOST_REQUIRE_EQUAL(solution.pushCount, 1);
+    BOOST_REQUIRE(solution.optimal);
+}
+
+BOOST_AUTO_TEST_CASE(testSolveAlreadyWon) {
+    SB::Board board = loadLevel("assets/sokoban/Levels/autowin.lvl");
+    SB::Solution solution = SB::Solver(board).solve();
+
+    BOOST_REQUIRE(solution.solved());
+    BOOST_REQUIRE_EQUAL(solution.moves, "");
+}
+
+BOOST_AUTO_TEST_CASE(testSolveUnsolvable) {
+    std::stringstream ss;
+    ss << "5 5\n";
+    ss << "#####\n";
+    ss << "#A..#\n";
+    ss << "#.@.#\n";
+    ss << "#..a#\n";
+    ss << "#####\n";
+
+    SB::Board board;
+    ss >> board;
+    SB::Solution solution = SB::Solver(board).solve();
+
+    BOOST_REQUIRE(solution.status == SB::Solution::Status::Unsolvable);
+}
+
+BOOST_AUTO_TEST_CASE(testSolveShippedLevels) {
+    for (int level = 1; level <= 6; level++) {
+        std::string filename = "assets/sokoban/Levels/level" + std::to_string(level) + ".lvl";
+        SB::Board board = loadLevel(filename);
+
+        SB::Solution aStar = SB::Solver(board).solve();
+        BOOST_REQUIRE_MESSAGE(aStar.solved(), filename);
+        BOOST_REQUIRE_MESSAGE(replays(board, aStar.moves), filename);
+        BOOST_REQUIRE_EQUAL(aStar.moveCount, aStar.moves.size());
+
+        // both searches are optimal, so they have to agree on the move count
+        SB::SolverOptions options;
+        options.algorithm = SB::SolverOptions::Algorithm::IDAStar;
+        SB::Solution idaStar = SB::Solver(board, options).solve();
+        BOOST_REQUIRE_MESSAGE(idaStar.solved(), filename);
+        BOOST_REQUIRE_MESSAGE(replays(board, idaStar.moves), filename);
+        BOOST_REQUIRE_EQUAL(idaStar.moveCount, aStar.moveCount);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testSolveWeightedAndPushes) {
+    SB::Board board = loadLevel("assets/sokoban/Levels/level2.lvl");
+    SB::Solution optimal = SB::Solver(board).solve();
+
+    SB::SolverOptions weighted;
+    weighted.weight = 2.0;
+    SB::Solution fast = SB::Solver(board, weighted).solve();
+    BOOST_REQUIRE(fast.solved());
+    BOOST_REQUIRE(!fast.optimal);
+    BOOST_REQUIRE(replays(board, fast.moves));
+    BOOST_REQUIRE_LE(fast.moveCount, 2 * optimal.moveCount);
+
+    SB::SolverOptions pushes;
+    pushes.objective = SB::SolverOptions::Objective::Pushes;
+    SB::Solution fewestPushes = SB::Solver(board, pushes).solve();
+    BOOST_REQUIRE(fewestPushes.solved());
+    BOOST_REQUIRE(replays(board, fewestPushes.moves));
+    BOOST_REQUIRE_LE(fewestPushes.pushCount, optimal.pushCount);
+}
+
+BOOST_AUTO_TEST_CASE(testSolveSpareCratesWithIDAStar) {
+    // three crates for two goals, so pushes onto dead squares stay legal
+    std::stringstream ss;
+    ss << "6 8\n";
+    ss << "###a####\n";
+    ss << "#......#\n";
+    ss << "#.A.A..#\n";
+    ss << "#..@A..#\n";
+    ss << "#.....a#\n";
+    ss << "########\n";
+
+    SB::Board board;
+    ss >> board;
+    SB::Solution aStar = SB::Solver(board).solve();
+    BOOST_REQUIRE(aStar.solved());
+
+    for (double weight : {1.0, 1.5}) {
+        SB::SolverOptions options;
+        options.algorithm = SB::SolverOptions::Algorithm::IDAStar;
+        options.weight = weight;
+        options.maxNodes = 100000;
+        SB::Solution idaStar = SB::Solver(board, options).solve();
+        BOOST_REQUIRE(idaStar.solved());
+        BOOST_REQUIRE(replays(board, idaStar.moves));
+        BOOST_REQUIRE_LE(idaStar.moveCount, weight * aStar.moveCount);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testSolveNodeLimit) {
+    SB::Board board = loadLevel("assets/sokoban/Levels/level4.lvl");
+    SB::SolverOptions options;
+    options.maxNodes = 1;
+    SB::Solution solution = SB::Solver(board, options).solve();
+
+    BOOST_REQUIRE(solution.status == SB::Solution::Status::LimitReached);
+}
+
+BOOST_AUTO_TEST_CASE(testSolveTimeLimit) {
+    SB::Board board = loadLevel("assets/sokoban/Levels/level4.lvl");
+    SB::SolverOptions options;
+    options.algorithm = SB::SolverOptions::Algorithm::IDAStar;
+    options.timeLimit = 1e-9;
+    SB::Solution solution = SB::Solver(board, options).solve();
+
+    BOOST_REQUIRE(solution.status == SB::Solution::Status::TimedOut);
+}
+
+BOOST_AUTO_TEST_CASE(testThreadPoolRunsEveryTask) {
+    SB::ThreadPool pool(4);
+    std::atomic<int> count{0};
+    for (int i = 0; i < 100; i++) {
+        pool.submit([&pool, &count] {
+            // tasks submitted from a worker land on its own deque and get stolen from there
+            for (int j = 0; j < 10; j++) {
+                pool.submit([&count] { count++; });
+            }
+        });
+    }
+    pool.wait();
+    BOOST_REQUIRE_EQUAL(count, 1000);
+
+    pool.submit([] { throw std::runtime_error("task failed"); });
+    BOOST_REQUIRE_THROW(pool.wait(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(testBatchSolve) {
+    std::vector<SB::BatchLevel> levels = SB::loadLevels("assets/sokoban/Levels");
+    BOOST_REQUIRE_EQUAL(levels.size(), 14);
+    BOOST_REQUIRE_EQUAL(levels.front().name, "autowin.lvl");
+
+    SB::ThreadPool pool(3);
+    std::vector<SB::BatchResult> results = SB::solveBatch(levels, SB::SolverOptions(), pool);
+    BOOST_REQUIRE_EQUAL(results.size(), levels.size());
+    for (size_t i = 0; i < results.size(); i++) {
+        BOOST_REQUIRE_EQUAL(results[i].name, levels[i].name);
+        BOOST_REQUIRE(results[i].error.empty());
+        if (results[i].solution.solved()) {
+            BOOST_REQUIRE_MESSAGE(replays(levels[i].board, results[i].solution.moves),
+                                  results[i].name);
+        }
+    }
+
+    std::stringstream csv;
+    SB::writeCsv(csv, results);
+    std::string header;
+    std::getline(csv, header);
+    BOOST_REQUIRE_EQUAL(header, "level,result,moves,pushes,nodes,seconds,solution");
+}
+
+BOOST_AUTO_TEST_CASE(testLoadMultiLevelFile) {
+    std::string filename = "multi_level_test.lvl";
+    {
+        std::ofstream ofs(filename);
+        ofs << "3 3\n###\n#@#\n###\n\n";
+        ofs << "3 5\n#####\n#@Aa#\n#####\n";
+    }
+    std::vector<SB::BatchLevel> levels = SB::loadLevelFile(filename);
+    std::remove(filename.c_str());
+
+    BOOST_REQUIRE_EQUAL(levels.size(), 2);
+    BOOST_REQUIRE_EQUAL(levels[0].name, "multi_level_test.lvl#1");
+    BOOST_REQUIRE_EQUAL(levels[1].board.width(), 5);
+    BOOST_REQUIRE_EQUAL(SB::Solver(levels[1].board).solve().moves, "R");
+}
+
+BOOST_AUTO_TEST_CASE(testBatchKeepsGoingPastABadFile) {
+    std::string dir = "batch_error_test";
+    std::filesystem::create_directory(dir);
+    {
+        std::ofstream(dir + "/bad.lvl") << "not a level\n";
+        std::ofstream(dir + "/good.lvl") << "3 5\n#####\n#@Aa#\n#####\n";
+    }
+    std::vector<SB::BatchLevel> levels = SB::loadLevels(dir);
+    SB::ThreadPool pool(2);
+    std::vector<SB::BatchResult> results = SB::solveBatch(levels, SB::SolverOptions(), pool);
+    std::filesystem::remove_all(dir);
+
+    BOOST_REQUIRE_EQUAL(results.size(), 2);
+    BOOST_REQUIRE_EQUAL(results[0].name, "bad.lvl");
+    BOOST_REQUIRE(!results[0].error.empty());
+    BOOST_REQUIRE_EQUAL(results[1].name, "good.lvl");
+    BOOST_REQUIRE(results[1].error.empty());
+    BOOST_REQUIRE_EQUAL(results[1].solution.moves, "R");
+
+    std::stringstream csv;
+    SB::writeCsv(csv, results);
+    std::string line;
+    std::getline(csv, line);
+    std::getline(csv, line);
+    BOOST_REQUIRE_EQUAL(line.substr(0, 14), "bad.lvl,error,");
+}
+
+BOOST_AUTO_TEST_CASE(testReadXsbCollection) {
+    std::istringstream in(
+        "Sample collection\r\n"
+        "\n"
+        "; Tiny\n"
+        "#####\n"
+        "#@$.#\n"
+        "#####\n"
+        "\n"
+        "6#|#+$2-#|#4-#|#-*2-#|6#\n"
+        "Title: Packed\n"
+        "Author: nobody\n"
+        "Comment:\n"
+        "#### not a board\n"
+        "Comment-End:\n"
+        "\n"
+        "  ####\n"
+        "###  #\n"
+        "#@$ .#\n"
+        "######\n");
+    SB::XsbReader reader(in, "sample.xsb");
+    std::vector<SB::BatchLevel> levels;
+    SB::BatchLevel level;
+    while (reader.next(&level)) {
+        levels.push_back(level);
+    }
+
+    BOOST_REQUIRE_EQUAL(levels.size(), 3);
+    BOOST_REQUIRE_EQUAL(levels[0].name, "Tiny");
+    BOOST_REQUIRE_EQUAL(SB::Solver(levels[0].board).solve().moves, "R");
+
+    // run lengths, the player and a crate on goals
+    const SB::Board& packed = levels[1].board;
+    BOOST_REQUIRE_EQUAL(levels[1].name, "Packed");
+    BOOST_REQUIRE_EQUAL(packed.width(), 6);
+    BOOST_REQUIRE_EQUAL(packed.height(), 5);
+    BOOST_REQUIRE(packed.isStorageLocation(packed.playerIndex()));
+    BOOST_REQUIRE_EQUAL(packed.storageCount(), 2);
+    BOOST_REQUIRE_EQUAL(packed.matchedCount(), 1);
+    BOOST_REQUIRE(SB::Solver(packed).solve().solved());
+
+    // ragged rows are padded with floor
+    BOOST_REQUIRE_EQUAL(levels[2].name, "sample.xsb#3");
+    BOOST_REQUIRE_EQUAL(levels[2].board.width(), 6);
+    BOOST_REQUIRE(levels[2].board.at(0, 0) == SB::TileType::GROUNDS);
+    BOOST_REQUIRE_EQUAL(SB::Solver(levels[2].board).solve().moves, "RR");
+}
+
+BOOST_AUTO_TEST_CASE(testLevelPackRoundTrip) {
+    std::vector<SB::BatchLevel> levels = SB::loadLevels("assets/sokoban/Levels");
+    // the tiles alone cannot tell that the player stands on a storage location
+    std::string onGoal = "####"
+                         "#@A#"
+                         "#a.#"
+                         "####";
+    const SB::TileType* cells = reinterpret_cast<const SB::TileType*>(onGoal.data());
+    levels.push_back({"on goal", SB::Board(4, 4, cells, true), ""});
+    std::string filename = "level_pack_test.pack";
+    SB::LevelPack::write(filename, levels);
+    {
+        SB::LevelPack pack(filename);
+        BOOST_REQUIRE_EQUAL(pack.size(), levels.size());
+        for (size_t i = 0; i < levels.size(); i++) {
+            SB::PackedLevel level = pack.level(i);
+            BOOST_REQUIRE_EQUAL(level.name, levels[i].name);
+            BOOST_REQUIRE_EQUAL(level.goalCount, levels[i].board.storageCount());
+
+            const SB::Board& original = levels[i].board;
+            SB::Board board = pack.board(i);
+            std::ostringstream expected, actual;
+            expected << original;
+            actual << board;
+            BOOST_REQUIRE_EQUAL(actual.str(), expected.str());
+            BOOST_REQUIRE_EQUAL(board.storageCount(), original.storageCount());
+            BOOST_REQUIRE_EQUAL(board.boxCount(), original.boxCount());
+            BOOST_REQUIRE_EQUAL(board.matchedCount(), original.matchedCount());
+            BOOST_REQUIRE_EQUAL(board.hasPlayer(), original.hasPlayer());
+            if (board.hasPlayer()) {
+                BOOST_REQUIRE_EQUAL(board.playerIndex(), original.playerIndex());
+                BOOST_REQUIRE_EQUAL(board.isStorageLocation(board.playerIndex()),
+                                    original.isStorageLocation(original.playerIndex()));
+            }
+        }
+        BOOST_REQUIRE_THROW(pack.level(levels.size()), std::out_of_range);
+    }
+    std::remove(filename.c_str());
+
+    BOOST_REQUIRE_THROW(SB::LevelPack("assets/sokoban/Levels/level1.lvl"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(testTraceWritesChromeEvents) {
+    std::string filename = "trace_test.json";
+    SB::Trace& trace = SB::Trace::instance();
+    trace.start(filename);
+    trace.setThreadName("test");
+    {
+        std::vector<SB::BatchLevel> levels = SB::loadLevels("assets/sokoban/Levels");
+        levels.resize(3);
+        SB::ThreadPool pool(2);
+        SB::solveBatch(levels, SB::SolverOptions(), pool);
+    }
+    // more events than one buffer holds go through the writer thread
+    for (int i = 0; i < 5000; i++) {
+        SB::Trace::Scope scope("tick");
+    }
+    trace.stop();
+    BOOST_REQUIRE(!trace.enabled());
+
+    std::ifstream ifs(filename);
+    std::string text((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    ifs.close();
+    std::remove(filename.c_str());
+
+    auto count = [&text](const std::string& needle) {
+        size_t found = 0;
+        for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) {
+            found++;
+        }
+        return found;
+    };
+    BOOST_REQUIRE_EQUAL(text.rfind("{\"traceEvents\": [", 0), 0);
+    BOOST_REQUIRE(text.find("]}") != std::string::npos);
+    BOOST_REQUIRE_EQUAL(count("\"name\": \"solve\""), 3);
+    BOOST_REQUIRE_EQUAL(count("\"name\": \"tick\""), 5000);
+    BOOST_REQUIRE(text.find("\"args\": {\"name\": \"test\"}") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(testGenerateLevels) {
+    SB::GeneratorOptions options;
+    options.seed = 7;
+    options.minPushes = 5;
+    options.maxCandidates = 2000;
+
+    SB::ThreadPool one(1), two(2);
+    std::vector<SB::GeneratedLevel> levels = SB::generateLevels(options, 4, one);
+    std::vector<SB::GeneratedLevel> again = SB::generateLevels(options, 4, two);
+    BOOST_REQUIRE_EQUAL(levels.size(), 4);
+    BOOST_REQUIRE_EQUAL(again.size(), 4);
+
+    for (size_t i = 0; i < levels.size(); i++) {
+        // the same levels whatever the number of threads
+        std::ostringstream text, other;
+        text << levels[i].board;
+        other << again[i].board;
+        BOOST_REQUIRE_EQUAL(text.str(), other.str());
+
+        // written in the .lvl format and solvable as promised
+        std::istringstream in(text.str());
+        SB::Board board;
+        in >> board;
+        BOOST_REQUIRE_EQUAL(board.boxCount(), options.crates);
+        SB::Solution solution = SB::Solver(board).solve();
+        BOOST_REQUIRE(solution.solved());
+        BOOST_REQUIRE_GE(solution.pushCount, options.minPushes);
+        BOOST_REQUIRE(replays(board, solution.moves));
+        BOOST_REQUIRE_GE(levels[i].branching, options.minBranching);
+    }
+}